@@ -0,0 +1,55 @@
+/* arena_alloc.cc
+ *
+ * arena backed allocation for objects and STL containers owned by the
+ * allocator.
+ */
+
+/*-----------------------MODULE INCLUDES-----------------------*/
+#include <pthread.h>
+#include "arena_alloc.h"
+
+/*------------------MODULE LOCAL DEFINITIONS-------------------*/
+namespace {
+/* the Arena itself is not thread safe */
+pthread_mutex_t get_lock = PTHREAD_MUTEX_INITIALIZER;
+}
+
+/*--------------------BEGIN IMPLEMENTATION---------------------*/
+namespace ArenaAlloc {
+Arena arena = NULL;
+unsigned int generation = 1;
+
+/*
+ *============================
+ * ArenaAlloc::Use()
+ *============================
+ * makes +a+ the arena for arena objects and containers. free lists
+ * collected from a previous arena are dropped since that memory may
+ * be released along with it
+ ***/
+void Use(Arena a)
+{
+  if(a != arena)
+  {
+    arena = a;
+    generation++;
+  }
+}
+
+/*
+ *============================
+ * ArenaAlloc::Get()
+ *============================
+ * returns +bytes+ of uninitialized memory from the current arena.
+ * safe to call from the Parallel workers
+ ***/
+void* Get(size_t bytes)
+{
+  pthread_mutex_lock(&get_lock);
+  if(arena == NULL) Use(Arena_Create());
+  void* mem = Arena_GetMem(arena, bytes);
+  pthread_mutex_unlock(&get_lock);
+  return mem;
+}
+}
+
@@ -0,0 +1,125 @@
+/* arena backed allocation for objects and STL containers owned by the
+ * allocator. memory comes from a single Arena so the allocator state
+ * for a procedure can be released all at once instead of piece by
+ * piece through malloc/free.
+ */
+
+#ifndef __GUARD_ARENA_ALLOC_H
+#define __GUARD_ARENA_ALLOC_H
+
+#include <Shared.h>
+#include <cstddef>
+#include <new>
+
+namespace ArenaAlloc {
+  /* arena that objects and containers currently draw from */
+  extern Arena arena;
+  /* bumped whenever the arena changes so stale free lists are dropped */
+  extern unsigned int generation;
+
+  void Use(Arena);
+  void* Get(size_t bytes);
+
+  /* default constructs a T in the current arena. for the containers
+   * and other types that can not derive from ArenaObject. like an
+   * ArenaObject it is never destroyed: its memory, and the memory of
+   * any container built on ArenaAllocator, goes with the arena */
+  template<class T> T* New() {return new(Get(sizeof(T))) T();}
+}
+
+/*-------------------------ARENA OBJECTS--------------------------*/
+/* base for objects that should be created with new on the arena.
+ * delete is a no-op: the memory goes away with the arena */
+struct ArenaObject
+{
+  static void* operator new(size_t bytes) {return ArenaAlloc::Get(bytes);}
+  static void* operator new[](size_t bytes)
+    {return ArenaAlloc::Get(bytes);}
+  static void operator delete(void*) {}
+  static void operator delete[](void*) {}
+};
+
+/*-------------------------STL ALLOCATOR--------------------------*/
+/* stateless STL allocator drawing from ArenaAlloc::arena. single
+ * elements, which is what list and map nodes ask for, are recycled
+ * through a free list so containers with many erases do not keep
+ * growing the arena. larger blocks are simply left in the arena.
+ * the free lists are per thread so containers can grow on the
+ * Parallel workers. a node freed on a worker is only reused by that
+ * worker */
+template<class T>
+class ArenaAllocator
+{
+  public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  template<class U> struct rebind {typedef ArenaAllocator<U> other;};
+
+  ArenaAllocator() {}
+  ArenaAllocator(const ArenaAllocator&) {}
+  template<class U> ArenaAllocator(const ArenaAllocator<U>&) {}
+
+  pointer address(reference x) const {return &x;}
+  const_pointer address(const_reference x) const {return &x;}
+  size_type max_size() const {return size_t(-1) / sizeof(T);}
+  void construct(pointer p, const T& val) {new((void*)p) T(val);}
+  void destroy(pointer p) {p->~T();}
+
+  pointer allocate(size_type n, const void* = 0)
+  {
+    if(n == 1)
+    {
+      if(free_generation != ArenaAlloc::generation)
+      {
+        free_list = NULL;
+        free_generation = ArenaAlloc::generation;
+      }
+      if(free_list != NULL)
+      {
+        FreeNode* node = free_list;
+        free_list = node->next;
+        return reinterpret_cast<pointer>(node);
+      }
+    }
+    return static_cast<pointer>(ArenaAlloc::Get(Bytes(n)));
+  }
+
+  void deallocate(pointer p, size_type n)
+  {
+    if(n == 1 && free_generation == ArenaAlloc::generation)
+    {
+      FreeNode* node = reinterpret_cast<FreeNode*>(p);
+      node->next = free_list;
+      free_list = node;
+    }
+  }
+
+  bool operator==(const ArenaAllocator&) const {return true;}
+  bool operator!=(const ArenaAllocator&) const {return false;}
+
+  private:
+  struct FreeNode {FreeNode* next;};
+  static __thread FreeNode* free_list;
+  static __thread unsigned int free_generation;
+
+  /* every block must be large enough to hold a free list link */
+  static size_t Bytes(size_type n)
+  {
+    size_t bytes = n * sizeof(T);
+    return bytes < sizeof(FreeNode) ? sizeof(FreeNode) : bytes;
+  }
+};
+
+template<class T> __thread
+typename ArenaAllocator<T>::FreeNode* ArenaAllocator<T>::free_list = NULL;
+template<class T> __thread
+unsigned int ArenaAllocator<T>::free_generation = 0;
+
+#endif
+
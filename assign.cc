@@ -28,6 +28,7 @@
 #include "cfg_tools.h"
 #include "params.h"
 #include "chow_extensions.h"
+#include "liveness.h"
 
 /*------------------MODULE LOCAL DECLARATIONS------------------*/
 namespace {
@@ -130,7 +131,7 @@ void StoreIfNeeded(AssignedReg* tmpReg, Inst* origInst, Block* blk);
 AssignedReg* FindInRegPool(LRID lrid, AssignedRegList* regpool);
 void ResetRegSpan(AssignedReg* startingReg, uint width);
 void StoreAndResetRegSpan( AssignedReg* , Inst* , Block* , uint );
-bool LiveIn(LRID orig_lrid, Block* blk);
+using Liveness::LiveIn;
 
 //for local allocation
 bool recompute_dist_map = true;
@@ -370,6 +371,16 @@ void HandleCopy(Block* blk,
   Register* destp = &((*op)->arguments[1]);
   
   LRID src_lrid = Mapping::SSAName2OrigLRID(*srcp);
+
+  //a copy between two names of the same live range (for example after
+  //coalescing) does not move the value anywhere, so just delete it
+  if(src_lrid == Mapping::SSAName2OrigLRID(*destp))
+  {
+    debug("deleting copy inside lrid: %d", src_lrid);
+    *op = NULL;
+    return;
+  }
+
   *srcp = GetMachineRegAssignment(blk, src_lrid);
   if(*srcp == REG_UNALLOCATED)
   {
@@ -586,7 +597,7 @@ void InsertCopy(AssignedReg* tmpReg, Edge* succ_edge)
   Edge_Extension* ee = AddEdgeExtensionNode(succ_edge, msd);
 
   //remove load for this register from the edge list
-  typedef std::list<MovedSpillDescription> L;
+  typedef SpillList L;
   L* spill_list = ee->spill_list;
   bool found_load = false;
   for(L::iterator it = spill_list->begin(); it != spill_list->end(); it++)
@@ -610,7 +621,7 @@ void InsertCopy(AssignedReg* tmpReg, Edge* succ_edge)
  * orignal lrid. (it may have chaged due to splitting) */
 inline LiveRange* RealLR(LRID orig_lrid, Block* blk)
 {
-  typedef std::map<unsigned int, LiveRange*> M;
+  typedef BlockMap M;
   M* blockmap = Chow::live_ranges[orig_lrid]->blockmap;
   M::iterator it = blockmap->find(bid(blk));
   assert(it != blockmap->end());
@@ -626,7 +637,7 @@ inline LiveRange* RealLR(LRID orig_lrid, Block* blk)
  * block. the live range does not have to have originally contained
  * the block.
  **/
-inline bool InMap(const std::map<uint, LiveRange*>* m, uint key)
+inline bool InMap(const BlockMap* m, uint key)
 {return m->find(key) != m->end();}
 inline bool IsAllocated(LRID lrid, Block* blk)
 {
@@ -1471,7 +1482,7 @@ void BuildInstOrderingMap()
 } 
 
 bool NeedStore(AssignedReg* tmpReg, Inst* inst, Block* blk);
-bool LiveOut(LRID lrid, Block* blk);
+using Liveness::LiveOut;
 /*
  *=====================
  * StoreIfNeeded()
@@ -1553,36 +1564,6 @@ bool NeedStore(AssignedReg* tmpReg, Inst* inst, Block* blk)
   return need_store;
 }
 
-bool LiveOut(LRID lrid, Block* blk)
-{
-  using Mapping::SSAName2OrigLRID;
-  Liveness_Info info = SSA_live_out[bid(blk)];
-  for(uint i = 0; i < info.size; i++)
-  {
-    if((info.names[i] < SSA_def_count))//avoid junk in live_out set
-    {
-      if(SSAName2OrigLRID(info.names[i]) == lrid)
-      {
-        return true;
-      }
-    }
-  }
-  return false;
-}
-
-bool LiveIn(LRID orig_lrid, Block* blk)
-{
-  Liveness_Info info = SSA_live_in[bid(blk)];
-  for(LOOPVAR j = 0; j < info.size; j++)
-  {
-    if(orig_lrid == info.names[j])
-    {
-      return true;
-    }
-  }
-  return false;
-}
-
 /*
  *=====================
  * ResetForRegWidth()
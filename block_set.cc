@@ -0,0 +1,336 @@
+/* block_set.cc
+ *
+ * compressed set of basic block ids. see block_set.h
+ */
+
+/*-----------------------MODULE INCLUDES-----------------------*/
+#include <algorithm>
+#include <iterator>
+#include "block_set.h"
+
+/*------------------MODULE LOCAL DEFINITIONS-------------------*/
+namespace {
+/* orders chunks by key for searching the sorted chunk list */
+struct KeyBefore
+{
+  template<class C>
+  bool operator()(const C& c, uint key) const {return c.key < key;}
+};
+
+inline uint CountBits(uint word)
+{
+  return __builtin_popcount(word);
+}
+}
+
+/*--------------------BEGIN IMPLEMENTATION---------------------*/
+BlockSet::BlockSet()
+{
+}
+
+void BlockSet::insert(uint b)
+{
+  uint key = b >> CHUNK_BITS;
+  unsigned short low = b & (CHUNK_SIZE - 1);
+
+  Chunk* c = FindChunk(key);
+  if(c == NULL)
+  {
+    Chunk nc;
+    nc.key = key;
+    nc.count = 0;
+    ChunkVec::iterator pos = 
+      std::lower_bound(chunks.begin(), chunks.end(), key, KeyBefore());
+    c = &(*chunks.insert(pos, nc));
+  }
+
+  if(c->bitmap.empty())
+  {
+    ShortVec::iterator it = 
+      std::lower_bound(c->array.begin(), c->array.end(), low);
+    if(it != c->array.end() && *it == low) return;
+    c->array.insert(it, low);
+    c->count++;
+    if(c->count > ARRAY_MAX) ToBitmap(*c);
+  }
+  else
+  {
+    uint& word = c->bitmap[low / WORD_BITS];
+    uint bit = 1u << (low % WORD_BITS);
+    if(word & bit) return;
+    word |= bit;
+    c->count++;
+  }
+}
+
+void BlockSet::erase(uint b)
+{
+  uint key = b >> CHUNK_BITS;
+  unsigned short low = b & (CHUNK_SIZE - 1);
+
+  Chunk* c = FindChunk(key);
+  if(c == NULL) return;
+
+  if(c->bitmap.empty())
+  {
+    ShortVec::iterator it = 
+      std::lower_bound(c->array.begin(), c->array.end(), low);
+    if(it == c->array.end() || *it != low) return;
+    c->array.erase(it);
+    c->count--;
+  }
+  else
+  {
+    uint& word = c->bitmap[low / WORD_BITS];
+    uint bit = 1u << (low % WORD_BITS);
+    if(!(word & bit)) return;
+    word &= ~bit;
+    c->count--;
+    //switch back only well below the limit to avoid flip-flopping
+    if(c->count < ARRAY_MAX / 2) ToArray(*c);
+  }
+
+  if(c->count == 0)
+  {
+    chunks.erase(chunks.begin() + (c - &chunks[0]));
+  }
+}
+
+bool BlockSet::member(uint b) const
+{
+  const Chunk* c = FindChunk(b >> CHUNK_BITS);
+  return c != NULL && ChunkMember(*c, b & (CHUNK_SIZE - 1));
+}
+
+void BlockSet::clear()
+{
+  chunks.clear();
+}
+
+uint BlockSet::size() const
+{
+  uint size = 0;
+  for(ChunkVec::const_iterator it = chunks.begin(); it != chunks.end(); it++)
+    size += it->count;
+  return size;
+}
+
+bool BlockSet::empty() const
+{
+  return chunks.empty();
+}
+
+/*
+ *========================
+ * BlockSet::intersects()
+ *========================
+ * true if the two sets have a block in common. walks the chunks of
+ * both sets in key order and only compares chunks with the same key.
+ ***/
+bool BlockSet::intersects(const BlockSet& other) const
+{
+  ChunkVec::const_iterator i1 = chunks.begin();
+  ChunkVec::const_iterator i2 = other.chunks.begin();
+  while(i1 != chunks.end() && i2 != other.chunks.end())
+  {
+    if(i1->key < i2->key) i1++;
+    else if(i2->key < i1->key) i2++;
+    else
+    {
+      if(ChunksIntersect(*i1, *i2)) return true;
+      i1++; i2++;
+    }
+  }
+  return false;
+}
+
+/*
+ *========================
+ * BlockSet::Union()
+ *========================
+ * adds the blocks of other to this set. both chunk lists are sorted
+ * by key so they are merged in one pass, and chunks with the same key
+ * are merged by their representation.
+ ***/
+void BlockSet::Union(const BlockSet& other)
+{
+  if(other.chunks.empty() || &other == this) return;
+
+  ChunkVec merged;
+  merged.reserve(chunks.size() + other.chunks.size());
+  ChunkVec::iterator i1 = chunks.begin();
+  ChunkVec::const_iterator i2 = other.chunks.begin();
+  while(i1 != chunks.end() || i2 != other.chunks.end())
+  {
+    if(i1 == chunks.end() || 
+       (i2 != other.chunks.end() && i2->key < i1->key))
+    {
+      merged.push_back(*i2);
+      i2++;
+      continue;
+    }
+    if(i2 != other.chunks.end() && i2->key == i1->key)
+    {
+      MergeChunk(*i1, *i2);
+      i2++;
+    }
+
+    //steal our own chunk rather than copying it
+    merged.push_back(Chunk());
+    Chunk& c = merged.back();
+    c.key = i1->key;
+    c.count = i1->count;
+    c.array.swap(i1->array);
+    c.bitmap.swap(i1->bitmap);
+    i1++;
+  }
+  chunks.swap(merged);
+}
+
+/* appends the members of the set in increasing order */
+void BlockSet::elements(std::vector<uint>& out) const
+{
+  for(ChunkVec::const_iterator it = chunks.begin(); it != chunks.end(); it++)
+  {
+    uint base = it->key << CHUNK_BITS;
+    if(it->bitmap.empty())
+    {
+      for(uint i = 0; i < it->array.size(); i++)
+        out.push_back(base + it->array[i]);
+    }
+    else
+    {
+      for(uint i = 0; i < CHUNK_SIZE; i++)
+        if(it->bitmap[i / WORD_BITS] & (1u << (i % WORD_BITS)))
+          out.push_back(base + i);
+    }
+  }
+}
+
+/* approximate memory used by the set */
+uint BlockSet::bytes() const
+{
+  uint bytes = sizeof(BlockSet) + chunks.capacity() * sizeof(Chunk);
+  for(ChunkVec::const_iterator it = chunks.begin(); it != chunks.end(); it++)
+  {
+    bytes += it->array.capacity() * sizeof(unsigned short);
+    bytes += it->bitmap.capacity() * sizeof(uint);
+  }
+  return bytes;
+}
+
+/*-------------------BEGIN LOCAL DEFINITIONS-------------------*/
+/* binary search of the sorted chunk list */
+BlockSet::Chunk* BlockSet::FindChunk(uint key)
+{
+  ChunkVec::iterator it = 
+    std::lower_bound(chunks.begin(), chunks.end(), key, KeyBefore());
+  if(it != chunks.end() && it->key == key) return &(*it);
+  return NULL;
+}
+
+const BlockSet::Chunk* BlockSet::FindChunk(uint key) const
+{
+  ChunkVec::const_iterator it = 
+    std::lower_bound(chunks.begin(), chunks.end(), key, KeyBefore());
+  if(it != chunks.end() && it->key == key) return &(*it);
+  return NULL;
+}
+
+bool BlockSet::ChunkMember(const Chunk& c, uint low)
+{
+  if(c.bitmap.empty())
+    return std::binary_search(c.array.begin(), c.array.end(), 
+                              (unsigned short)low);
+  return (c.bitmap[low / WORD_BITS] & (1u << (low % WORD_BITS))) != 0;
+}
+
+bool BlockSet::ChunksIntersect(const Chunk& c1, const Chunk& c2)
+{
+  //two bitmaps, compare a word at a time
+  if(!c1.bitmap.empty() && !c2.bitmap.empty())
+  {
+    for(uint i = 0; i < c1.bitmap.size(); i++)
+      if(c1.bitmap[i] & c2.bitmap[i]) return true;
+    return false;
+  }
+
+  //an array and a bitmap, probe the bitmap
+  if(!c1.bitmap.empty() || !c2.bitmap.empty())
+  {
+    const Chunk& arr = c1.bitmap.empty() ? c1 : c2;
+    const Chunk& bmp = c1.bitmap.empty() ? c2 : c1;
+    for(uint i = 0; i < arr.array.size(); i++)
+      if(ChunkMember(bmp, arr.array[i])) return true;
+    return false;
+  }
+
+  //two sorted arrays, merge
+  ShortVec::const_iterator a1 = c1.array.begin();
+  ShortVec::const_iterator a2 = c2.array.begin();
+  while(a1 != c1.array.end() && a2 != c2.array.end())
+  {
+    if(*a1 < *a2) a1++;
+    else if(*a2 < *a1) a2++;
+    else return true;
+  }
+  return false;
+}
+
+/* adds the blocks of from to into, both chunks have the same key */
+void BlockSet::MergeChunk(Chunk& into, const Chunk& from)
+{
+  //two sorted arrays, merge them and switch to a bitmap if too big
+  if(into.bitmap.empty() && from.bitmap.empty())
+  {
+    ShortVec array;
+    array.reserve(into.array.size() + from.array.size());
+    std::set_union(into.array.begin(), into.array.end(),
+                   from.array.begin(), from.array.end(),
+                   std::back_inserter(array));
+    into.array.swap(array);
+    into.count = into.array.size();
+    if(into.count > ARRAY_MAX) ToBitmap(into);
+    return;
+  }
+
+  if(into.bitmap.empty()) ToBitmap(into);
+  if(from.bitmap.empty())
+  {
+    for(uint i = 0; i < from.array.size(); i++)
+    {
+      uint& word = into.bitmap[from.array[i] / WORD_BITS];
+      uint bit = 1u << (from.array[i] % WORD_BITS);
+      if(!(word & bit)) into.count++;
+      word |= bit;
+    }
+  }
+  else
+  {
+    into.count = 0;
+    for(uint i = 0; i < into.bitmap.size(); i++)
+    {
+      into.bitmap[i] |= from.bitmap[i];
+      into.count += CountBits(into.bitmap[i]);
+    }
+  }
+}
+
+void BlockSet::ToBitmap(Chunk& c)
+{
+  c.bitmap.assign(CHUNK_SIZE / WORD_BITS, 0);
+  for(uint i = 0; i < c.array.size(); i++)
+    c.bitmap[c.array[i] / WORD_BITS] |= 1u << (c.array[i] % WORD_BITS);
+  ShortVec().swap(c.array);
+}
+
+void BlockSet::ToArray(Chunk& c)
+{
+  ShortVec array;
+  array.reserve(c.count);
+  for(uint i = 0; i < CHUNK_SIZE; i++)
+    if(c.bitmap[i / WORD_BITS] & (1u << (i % WORD_BITS)))
+      array.push_back(i);
+  c.array.swap(array);
+  WordVec().swap(c.bitmap);
+}
@@ -0,0 +1,60 @@
+/* a compressed set of basic block ids used to record the blocks that
+ * make up a live range. most live ranges only span a handful of
+ * blocks so the set is kept in chunks that hold a sorted array of
+ * block ids until they get dense enough to switch to a bitmap.
+ */
+
+#ifndef __GUARD_BLOCK_SET_H
+#define __GUARD_BLOCK_SET_H
+
+#include <vector>
+#include "types.h"
+#include "arena_alloc.h"
+
+class BlockSet : public ArenaObject {
+  public:
+  /* constructor */
+  BlockSet();
+
+  /* methods */
+  void insert(uint b);
+  void erase(uint b);
+  bool member(uint b) const;
+  void clear();
+  uint size() const;
+  bool empty() const;
+  bool intersects(const BlockSet& other) const;
+  void Union(const BlockSet& other);
+  void elements(std::vector<uint>& out) const;
+  uint bytes() const;
+
+  private:
+  /* all blocks in a chunk share the high bits of their id. the low
+   * bits are kept in a sorted array until the chunk holds more than
+   * ARRAY_MAX blocks and then in a bitmap */
+  static const uint CHUNK_BITS = 12;
+  static const uint CHUNK_SIZE = 1 << CHUNK_BITS;
+  static const uint ARRAY_MAX = 256;
+  static const uint WORD_BITS = 32;
+  typedef std::vector<unsigned short, ArenaAllocator<unsigned short> > 
+    ShortVec;
+  typedef std::vector<uint, ArenaAllocator<uint> > WordVec;
+  struct Chunk
+  {
+    uint key;
+    uint count;
+    ShortVec array; /* used when bitmap is empty */
+    WordVec bitmap;
+  };
+  typedef std::vector<Chunk, ArenaAllocator<Chunk> > ChunkVec;
+  ChunkVec chunks; /* sorted by key */
+
+  Chunk* FindChunk(uint key);
+  const Chunk* FindChunk(uint key) const;
+  static bool ChunkMember(const Chunk& c, uint low);
+  static bool ChunksIntersect(const Chunk& c1, const Chunk& c2);
+  static void MergeChunk(Chunk& into, const Chunk& from);
+  static void ToBitmap(Chunk& c);
+  static void ToArray(Chunk& c);
+};
+#endif
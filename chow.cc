@@ -34,6 +34,10 @@
 #include "rematerialize.h" //Global namespace for iloc Shared vars
 #include "heuristics.h" //heuristics for splitting, etc.
 #include "reach.h"
+#include "coalesce.h"
+#include "operands.h"
+#include "liveness.h"
+#include "parallel.h"
 
 
 /*------------------MODULE LOCAL DEFINITIONS-------------------*/
@@ -42,31 +46,78 @@ namespace {
   void assert_same_orig_name(LRID,Variable,SparseSet,Block* b);
   void MoveLoadsAndStores();
   unsigned int FindLiveRanges(Arena uf_arena);
-  void CreateLiveRanges(Arena arena, Unsigned_Int num_lrs);
-  void SplitNeighbors(LiveRange*, LRSet*, LRSet*);
-  void UpdateConstrainedLists(LiveRange* , LiveRange* , LRSet*, LRSet*);
-  void UpdateConstrainedListsAfterDelete(LiveRange*, LRSet*, LRSet*);
+  void CreateLiveRanges(Unsigned_Int num_lrs);
+  void SplitNeighbors(LiveRange*, LRIDSet*, LRIDSet*);
+  /* constrained list changes gathered during a round of splits */
+  enum ListUpdate
+  {
+    UPDATE_NEW = 1,     /* new live range carved out by a split */
+    UPDATE_SHRUNK = 2,  /* remainder of a split live range */
+    UPDATE_PROMOTE = 4  /* neighbor of both halves of a split */
+  };
+  typedef std::map<LRID, int> ListUpdates;
+  void NoteSplit(LiveRange*, LiveRange*, ListUpdates*);
+  void ApplyListUpdates(const ListUpdates&, LRIDSet*, LRIDSet*);
+  void UpdateConstrainedListsAfterDelete(LiveRange*, LRIDSet*, LRIDSet*);
   LiveUnit* AddLiveUnitOnce(LRID, Block*, SparseSet, Variable);
-  LiveRange* ComputePriorityAndChooseTop(LRSet*, LRSet*);
+  LiveRange* ComputePriorityAndChooseTop(LRIDSet*, LRIDSet*);
   void BuildInitialLiveRanges(Arena);
   void BuildInterferences(Arena arena);
+  void RebuildLiveRanges(Arena arena, Unsigned_Int num_lrs);
+  void CreateLiveRangesWithStats(Unsigned_Int num_lrs);
+  void MarkAllLoadsAndStores(Arena arena);
+  void ClearEdgeExtensions();
+
+  /* live ranges waiting for a priority and whether each turned out to
+   * be not worth a register. char rather than bool so the slots can
+   * be written from different threads */
+  struct PriorityWork
+  {
+    std::vector<LiveRange*> pending;
+    std::vector<char> worthless;
+  };
+  void MarkLoadsAndStoresRange(void*, Unsigned_Int, Unsigned_Int,
+                               Unsigned_Int);
+  void ComputePrioritiesRange(void*, Unsigned_Int, Unsigned_Int,
+                              Unsigned_Int);
+  /* phi nodes to union and what each worker found. the remat splits
+   * are kept per worker and replayed in phi order afterwards */
+  struct PhiWork
+  {
+    std::vector<Phi_Node*> phis;
+    bool concurrent;
+    std::vector<unsigned int> merged;
+    std::vector<std::vector<std::pair<Variable,Variable> > > remat_splits;
+  };
+  void UnionPhisRange(void*, Unsigned_Int, Unsigned_Int, Unsigned_Int);
+  bool UnionNames(UFSet*, Variable, Variable, bool concurrent);
   void AllocateRegisters();
+  void AllocateRegisterClass(LRIDSet* constr_lrs, LRIDSet* unconstr_lrs);
+  void StartClassBudget(size_t class_lrs, size_t lrs_left);
+  int BudgetShare(int budget, size_t class_lrs, size_t lrs_left);
+  /* share of the split limit given to the class being allocated, and
+   * the split count when the class started. negative for no limit */
+  int class_split_limit = -1;
+  Unsigned_Int class_first_split = 0;
+  void LinearScanAllocate();
+  void FinishAfterDeadline(LRIDSet*);
+  bool UseLinearScanTier();
+  unsigned int FirstBlock(LiveRange* lr);
   void RenameRegisters();
   bool ShouldSplitLiveRange(LiveRange* lr);
-  inline void AddToCorrectConstrainedList(LRSet*,LRSet*,LiveRange*);
+  inline void AddToCorrectConstrainedList(LRIDSet*,LRIDSet*,LiveRange*);
   void CountLocals();
   void DumpLocals();
-  void SeparateConstrainedLiveRanges(LRSet*, LRSet*);
-  void ColorUnconstrained(LRSet* unconstr_lrs);
-  void PullNodeFromGraph(LiveRange* lr, LRSet* constr_lrs);
-  bool LiveIn(LRID orig_lrid, Block* blk);
+  void SeparateConstrainedLiveRanges(LRIDSet*, LRIDSet*);
+  void ColorUnconstrained(LRIDSet* unconstr_lrs);
+  void PullNodeFromGraph(LiveRange* lr, LRIDSet* constr_lrs);
 }
 
 /*--------------------BEGIN IMPLEMENTATION---------------------*/
 namespace Chow {
   /* globals */
   Arena arena;
-  LRVec live_ranges;
+  LiveRangeView live_ranges;
   std::vector<std::vector<LiveUnit*> > live_units;
   std::map<Variable,bool> local_names;
   std::stack<LiveRange*> color_stack;
@@ -77,6 +128,7 @@ void Chow::Run()
   //--- Initialization for building live ranges ---//
   //arena for all chow memory allocations
   if(arena == NULL){arena = Arena_Create(); }
+  Stats::StartDeadline(Params::Algorithm::deadline_msecs);
 
   //--- Build live ranges ---//
   BuildInitialLiveRanges(arena);
@@ -90,27 +142,45 @@ void Chow::Run()
   //--- Initialization for allocating registers ---//
   //compute loop nesting depth needed for computing priorities
   find_nesting_depths(arena); Globals::depths = depths;
+  Globals::loop_heads = loop_heads;
+  //the cached unit priority terms need the depths
+  for(LRVec::size_type i = 0; i < live_ranges.size(); i++)
+    live_ranges[i]->RefreshPriorityTerms();
   Spill::Init(arena);
-  if(Params::Algorithm::move_loads_and_stores)
-  {
-    //clear out edge extensions 
-    Block* b;
-    Edge* e;
-    ForAllBlocks(b)
-    {
-      Block_ForAllPreds(e,b) e->edge_extension = NULL;
-      Block_ForAllSuccs(e,b) e->edge_extension = NULL;
-    }
-  }
+  if(Params::Algorithm::move_loads_and_stores) ClearEdgeExtensions();
 
   //--- Run the priority algorithm ---//
-    Stats::Start("Allocate Registers");
-  AllocateRegisters();
-  if(Debug::dot_dump_lr) Debug::DotDumpFinalLRs(); 
-    Stats::Stop();
+  if(UseLinearScanTier())
+  {
+      Stats::Start("Linear Scan");
+    Stats::chowstats.fLinearScanTier = TRUE;
+    LinearScanAllocate();
+      Stats::Stop();
+  }
+  else
+  {
+      Stats::Start("Allocate Registers");
+    AllocateRegisters();
+    if(Debug::dot_dump_lr) Debug::DotDumpFinalLRs(); 
+      Stats::Stop();
+  }
     Stats::Start("Rename Registers");
   RenameRegisters();
     Stats::Stop();
+
+  //moving loads and stores was the last use of the reach sets
+  Reach::Release();
+
+  //--- Record interference set memory for the stats report ---//
+  Stats::chowstats.cFearListPeakBytes = LazySet::peak_bytes;
+  Stats::chowstats.cFearListDenseBytes = LazySet::dense_peak_bytes;
+
+  //--- Release the live ranges ---//
+  //nothing after renaming looks at the live ranges or the spills
+  //moved onto edges, so they all go at once with their arena
+  ClearEdgeExtensions();
+  Debug::dot_dumped_lrs.clear();
+  LiveRange::Release();
 }
 
 /*-----------------INTERNAL MODULE FUNCTIONS-------------------*/
@@ -126,10 +196,10 @@ namespace {
 void AllocateRegisters()
 {
   using Chow::live_ranges;
+  using RegisterClass::all_classes;
 
-  LiveRange* lr;
-  LRSet constr_lrs;
-  LRSet unconstr_lrs;
+  LRIDSet constr_lrs;
+  LRIDSet unconstr_lrs;
 
   //the register that holds the frame pointer is not a candidate for
   //allocation since it resides in a special reserved register. remove
@@ -140,30 +210,250 @@ void AllocateRegisters()
   //separate unconstrained live ranges
   SeparateConstrainedLiveRanges(&constr_lrs, &unconstr_lrs);
 
-  //assign registers to constrained live ranges
-  lr = NULL;
-  while(!(constr_lrs.empty()))
+  //live ranges of different classes never interfere and draw from
+  //different colors, so the constrained live ranges are partitioned
+  //by class and each class is allocated on its own, one after the
+  //other. this keeps the priority scan over only the live ranges of
+  //one class. splits of a live range stay in its class so the per
+  //class lists stay separate.
+  //
+  //the classes are not run on separate threads. a split appends to
+  //Chow::live_ranges and the LRTable columns, takes the next id from
+  //LiveRange::counter and allocates from the arena and the
+  //ArenaAllocator free lists, none of which can be shared between
+  //threads as they are
+  std::vector<LRIDSet> class_lrs(all_classes.size());
+  for(LRIDSet::iterator i = constr_lrs.begin(); i != constr_lrs.end(); i++)
+  {
+    for(unsigned int c = 0; c < all_classes.size(); c++)
+    {
+      if(live_ranges[*i]->rc == all_classes[c])
+        {class_lrs[c].insert(*i); break;}
+    }
+  }
+  size_t lrs_left = constr_lrs.size();
+  for(unsigned int c = 0; c < all_classes.size(); c++)
+  {
+    debug("allocating class %d: %d constrained lrs", 
+          all_classes[c], (int)class_lrs[c].size());
+    if(class_lrs[c].empty()) continue;
+    StartClassBudget(class_lrs[c].size(), lrs_left);
+    lrs_left -= class_lrs[c].size();
+    AllocateRegisterClass(&class_lrs[c], &unconstr_lrs);
+  }
+  class_split_limit = -1;
+
+  //assign registers to unconstrained live ranges
+  debug("assigning unconstrained live ranges colors");
+  ColorUnconstrained(&unconstr_lrs);
+
+  //record some statistics about the allocation
+  Stats::chowstats.clrFinal = live_ranges.size();
+}
+
+/*
+ *=========================
+ * AllocateRegisterClass()
+ *=========================
+ *
+ * Runs the priority and split loop over the constrained live ranges
+ * of a single register class. Live ranges that become unconstrained
+ * are moved to +unconstr_lrs+ to be colored at the end.
+ *
+ ***/
+void AllocateRegisterClass(LRIDSet* constr_lrs, LRIDSet* unconstr_lrs)
+{
+  LiveRange* lr = NULL;
+  while(!(constr_lrs->empty()))
   {
+    //out of time, finish up cheaply
+    if(Stats::DeadlineExpired())
+    {
+      FinishAfterDeadline(constr_lrs);
+      break;
+    }
+
     //steps 2: (a) - (c)
-    lr = ComputePriorityAndChooseTop(&constr_lrs, &unconstr_lrs);
+    lr = ComputePriorityAndChooseTop(constr_lrs, unconstr_lrs);
     if(lr == NULL)
     {
       debug("No more constrained lrs can be assigned");
       break;
     }
     lr->AssignColor();
-    debug("LR: %d is top priority, given color: %d", lr->id, lr->color);
-    SplitNeighbors(lr, &constr_lrs, &unconstr_lrs);
+    debug("LR: %d is top priority, given color: %d", lr->id, lr->color());
+    SplitNeighbors(lr, constr_lrs, unconstr_lrs);
   }
+}
 
-  //assign registers to unconstrained live ranges
-  debug("assigning unconstrained live ranges colors");
-  ColorUnconstrained(&unconstr_lrs);
+/*
+ *=========================
+ * StartClassBudget()
+ *=========================
+ *
+ * Gives the next register class its share of the split limit and of
+ * the time left before the deadline. The share is in proportion to
+ * the number of constrained live ranges in the class, so one class
+ * can not use up the budget of the classes allocated after it. What
+ * a class leaves unused is shared out among the classes after it.
+ *
+ ***/
+void StartClassBudget(size_t class_lrs, size_t lrs_left)
+{
+  using Params::Algorithm::split_limit;
+  using Stats::chowstats;
+
+  class_first_split = chowstats.cSplits;
+  if(split_limit)
+  {
+    int splits_left = std::max(0, split_limit - (int)chowstats.cSplits);
+    class_split_limit = BudgetShare(splits_left, class_lrs, lrs_left);
+  }
+
+  int class_msecs = Stats::DeadlineMsecsLeft();
+  if(class_msecs >= 0)
+  {
+    class_msecs = BudgetShare(class_msecs, class_lrs, lrs_left);
+    Stats::StartDeadlineSlice(class_msecs);
+  }
+  debug("class budget: %d splits, %d msecs (-1 is unlimited)",
+        class_split_limit, class_msecs);
+}
+
+/*
+ *=========================
+ * BudgetShare()
+ *=========================
+ *
+ * The part of +budget+ that goes to a class with +class_lrs+ of the
+ * +lrs_left+ constrained live ranges still to be allocated, rounded
+ * up so a small class is not left with nothing.
+ *
+ ***/
+int BudgetShare(int budget, size_t class_lrs, size_t lrs_left)
+{
+  if(lrs_left <= class_lrs) return budget;
+  return (int)(((double)budget * class_lrs + lrs_left - 1) / lrs_left);
+}
+
+/*
+ *=======================
+ * FinishAfterDeadline()
+ *=======================
+ *
+ * Called when the allocation deadline passes with constrained live
+ * ranges left. Each remaining live range is given a color if one is
+ * free in all of its blocks and otherwise spilled. No more priorities
+ * are computed and nothing else is split.
+ *
+ ***/
+void FinishAfterDeadline(LRIDSet* constr_lrs)
+{
+  debug("deadline expired with %d constrained lrs left", 
+        (int)constr_lrs->size());
+
+  //the set is in id order so the result does not depend on memory
+  //layout
+  std::vector<LRID> remaining(constr_lrs->begin(), constr_lrs->end());
+  constr_lrs->clear();
+  for(unsigned int i = 0; i < remaining.size(); i++)
+  {
+    LiveRange* lr = Chow::live_ranges[remaining[i]];
+    Stats::chowstats.cDegraded++;
+    if(lr->HasColorAvailable() && lr->GetPriority() > 0)
+    {
+      lr->AssignColor();
+    }
+    else
+    {
+      lr->MarkNonCandidateAndDelete(); 
+      Stats::chowstats.cSpills++;
+    }
+  }
+}
+
+/*
+ *=======================
+ * UseLinearScanTier()
+ *=======================
+ *
+ * Decides if the procedure is big enough that we should use the fast
+ * linear scan tier instead of the full priority algorithm.
+ *
+ ***/
+bool UseLinearScanTier()
+{
+  int threshold = Params::Algorithm::linear_scan_blocks;
+  return (threshold > 0) && ((int)block_count >= threshold);
+}
+
+/*
+ *=======================
+ * LinearScanAllocate()
+ *=======================
+ *
+ * Fast allocation tier for very large procedures. Each live range is
+ * visited once in order of its first block and given a color if one
+ * is free across all of its blocks, otherwise it is spilled. There is
+ * no priority ordering and no splitting so the cost is linear in the
+ * size of the interference graph. The loads and stores computed for
+ * the initial live ranges and the normal renaming step are used
+ * unchanged.
+ *
+ ***/
+void LinearScanAllocate()
+{
+  using Chow::live_ranges;
+
+  //the frame pointer lives in a reserved register
+  live_ranges[Spill::frame.lrid]->MarkNonCandidateAndDelete();
+
+  //sort by starting block, breaking ties by id so that the
+  //allocation does not depend on memory layout
+  std::vector<std::pair<unsigned int, LRID> > order;
+  for(LRVec::size_type i = 1; i < live_ranges.size(); i++)
+  {
+    LiveRange* lr = live_ranges[i];
+    if(Params::Algorithm::allocate_locals || !lr->is_local)
+      order.push_back(std::make_pair(FirstBlock(lr), lr->id));
+    else
+      lr->MarkNonCandidateAndDelete();
+  }
+  std::sort(order.begin(), order.end());
+
+  for(unsigned int i = 0; i < order.size(); i++)
+  {
+    LiveRange* lr = live_ranges[order[i].second];
+    if(lr->HasColorAvailable() && 
+       (Params::Algorithm::allocate_all_unconstrained || 
+        lr->GetPriority() > 0))
+    {
+      lr->AssignColor();
+      debug("LR: %d is given color:%d", lr->id, lr->color());
+    }
+    else
+    {
+      debug("LR: %d spilled by linear scan", lr->id);
+      lr->MarkNonCandidateAndDelete();
+      Stats::chowstats.cSpills++;
+    }
+  }
 
-  //record some statistics about the allocation
   Stats::chowstats.clrFinal = live_ranges.size();
 }
 
+/* returns the smallest block id in the live range */
+unsigned int FirstBlock(LiveRange* lr)
+{
+  unsigned int first = block_count+1;
+  for(LiveRange::iterator it = lr->begin(); it != lr->end(); it++)
+  {
+    unsigned int b = bid((*it)->block);
+    if(b < first) first = b;
+  }
+  return first;
+}
+
 /*
  *=======================================
  * ComputePriorityAndChooseTop()
@@ -171,32 +461,33 @@ void AllocateRegisters()
  *
  ***/
 LiveRange* 
-ComputePriorityAndChooseTop(LRSet* constr_lrs, LRSet* unconstr_lrs)
+ComputePriorityAndChooseTop(LRIDSet* constr_lrs, LRIDSet* unconstr_lrs)
 {
   std::vector<LiveRange*> deletes;
   
-  //compute priority for all live ranges
-  for(LRSet::iterator i = constr_lrs->begin(); i != constr_lrs->end(); i++)
+  //find the live ranges whose priority has never been computed. only
+  //the priority column is read until one is found
+  PriorityWork work;
+  std::vector<LiveRange*>& pending = work.pending;
+  for(LRIDSet::iterator i = constr_lrs->begin(); i != constr_lrs->end(); i++)
   {
-    LiveRange* lr = *i;
-    assert(lr->is_candidate);
+    assert(LRTable::is_candidate[*i]);
+    if(LRTable::priority[*i] == LiveRange::UNDEFINED_PRIORITY)
+      pending.push_back(Chow::live_ranges[*i]);
+  }
 
-    //priority has never been computed
-    if(lr->priority == LiveRange::UNDEFINED_PRIORITY)
-    {
-      lr->ComputePriority();
-      debug("priority for LR: %d is %.3f", lr->id, lr->priority);
-
-      //check to see if this live range is a non-candidate for
-      //allocation. I think we need to only check this the first time
-      //we compute the priority function. if the priority changes due
-      //to a live range split it should be reset to undefined so we
-      //can compute it again.
-      if(lr->priority <= 0.0 || lr->IsEntirelyUnColorable())
-      {
-        deletes.push_back(lr);
-      }
-    }
+  //the priorities only read shared state so they are computed in
+  //parallel. each slot of +worthless+ belongs to a single worker
+  work.worthless.resize(pending.size(), 0);
+  Parallel::ForRange(pending.size(), ComputePrioritiesRange, &work);
+
+  //collect the deletes in set order so the result does not depend on
+  //how the work was divided
+  for(unsigned int i = 0; i < pending.size(); i++)
+  {
+    debug("priority for LR: %d is %.3f", pending[i]->id, 
+          pending[i]->priority());
+    if(work.worthless[i]) deletes.push_back(pending[i]);
   }
 
   //remove any live ranges not deemed worthy
@@ -209,25 +500,50 @@ ComputePriorityAndChooseTop(LRSet* constr_lrs, LRSet* unconstr_lrs)
 
   //find the top priority live range
   float top_prio = -3.4e38; //a very small number
-  LiveRange* top_lr = NULL;
-  for(LRSet::iterator i = constr_lrs->begin(); i != constr_lrs->end(); i++)
+  LRID top_lrid = NO_LRID;
+  for(LRIDSet::iterator i = constr_lrs->begin(); i != constr_lrs->end(); i++)
   {
-    LiveRange* lr = *i;
-
     //see if this live range has a greater priority
-    if(lr->priority > top_prio)
+    if(LRTable::priority[*i] > top_prio)
     {
-      top_prio = lr->priority;
-      top_lr = lr;
+      top_prio = LRTable::priority[*i];
+      top_lrid = *i;
     }
   }
 
-  if(top_lr != NULL)
+  if(top_lrid == NO_LRID) return NULL;
+  debug("top priority is %.3f LR: %d", top_prio, top_lrid);
+  constr_lrs->erase(top_lrid);
+  return Chow::live_ranges[top_lrid];
+}
+
+/*
+ *=============================
+ * ComputePrioritiesRange()
+ *=============================
+ * Parallel::Work that computes the priorities for a slice of the
+ * pending live ranges and flags the ones that are not worth a
+ * register.
+ *
+ ***/
+void ComputePrioritiesRange(void* arg, Unsigned_Int lo, Unsigned_Int hi,
+                            Unsigned_Int)
+{
+  PriorityWork* work = static_cast<PriorityWork*>(arg);
+  std::vector<LiveRange*>& pending = work->pending;
+  std::vector<char>& worthless = work->worthless;
+  for(Unsigned_Int i = lo; i < hi; i++)
   {
-    debug("top priority is %.3f LR: %d", top_prio, top_lr->id);
-    constr_lrs->erase(top_lr);
+    LiveRange* lr = pending[i];
+    lr->ComputePriority();
+
+    //check to see if this live range is a non-candidate for
+    //allocation. I think we need to only check this the first time
+    //we compute the priority function. if the priority changes due
+    //to a live range split it should be reset to undefined so we
+    //can compute it again.
+    worthless[i] = (lr->priority() <= 0.0 || lr->IsEntirelyUnColorable());
   }
-  return top_lr;
 }
 
 /*
@@ -250,9 +566,13 @@ void BuildInitialLiveRanges(Arena chow_arena)
 {
   using Chow::live_ranges;
 
+  //the union find sets are only needed until the live range names
+  //are final, after coalescing and the rematerialization splits
+  Arena uf_arena = Arena_Create();
+
   //run union find over phi nodes to get initial live ranges
     Stats::Start("Create LiveRanges");
-  unsigned int clrInitial = FindLiveRanges(chow_arena);
+  unsigned int clrInitial = FindLiveRanges(uf_arena);
   --clrInitial; //no lr for SSA name 0
 
   debug("SSA NAMES: %d", SSA_def_count);
@@ -262,14 +582,13 @@ void BuildInitialLiveRanges(Arena chow_arena)
   //create a mapping from ssa names to live range ids
   Mapping::CreateLiveRangeNameMap(chow_arena);
   Mapping::CreateLiveRangeTypeMap(chow_arena, clrInitial);
-  Mapping::ConvertLiveInNamespaceSSAToLiveRange();
+  Operands::Build();
 
   //initialize coloring structures based on number of register classes
   Coloring::Init(chow_arena, clrInitial);
 
   //now that we know how many live ranges we start with allocate them
-  Stats::ComputeBBStats(chow_arena, SSA_def_count);
-  CreateLiveRanges(chow_arena, clrInitial);
+  CreateLiveRangesWithStats(clrInitial);
     Stats::Stop();
 
   //find all interferenes for each live range
@@ -277,6 +596,31 @@ void BuildInitialLiveRanges(Arena chow_arena)
   BuildInterferences(chow_arena);
     Stats::Stop();
 
+  //merge copy related live ranges and rebuild until no more copies
+  //can be coalesced
+  if(Params::Algorithm::coalesce_copies)
+  {
+    Stats::Start("Coalesce Copies");
+    unsigned int coalesced;
+    while((coalesced = Coalesce::CoalesceCopies()) > 0)
+    {
+      debug("coalesced %d live ranges, rebuilding", coalesced);
+      Stats::chowstats.cCoalescedCopies += coalesced;
+      clrInitial -= coalesced;
+      RebuildLiveRanges(chow_arena, clrInitial);
+    }
+    Stats::chowstats.clrInitial = clrInitial;
+    Stats::Stop();
+  }
+
+  //live range construction was the last reader of the operand table
+  Operands::Release();
+
+  //the live units have picked up their SSA names so we can now switch
+  //the live in sets over to the live range namespace
+  Mapping::ConvertLiveInNamespaceSSAToLiveRange();
+  Liveness::Build(chow_arena, clrInitial);
+
   if(Params::Algorithm::rematerialize)
   {
     Stats::Start("Split Rematerializable");
@@ -300,9 +644,12 @@ void BuildInitialLiveRanges(Arena chow_arena)
     Stats::Stop();
   }
 
+  UFSets_Release();
+  Remat::remat_sets = NULL;
+  Arena_Destroy(uf_arena);
+
   //compute where the loads and stores need to go in the live range
-  for(LRVec::size_type i = 0; i < live_ranges.size(); i++)
-    live_ranges[i]->MarkLoadsAndStores();
+  MarkAllLoadsAndStores(chow_arena);
 
   Debug::LiveRange_DDumpAll(&live_ranges);
 }
@@ -312,7 +659,10 @@ void BuildInitialLiveRanges(Arena chow_arena)
  * FindLiveRanges()
  *=============================
  * Uses a fast union find algorithm to union phi-params to find out
- * which values belong in the same live range
+ * which values belong in the same live range. with more than one
+ * thread the phi nodes are split among the workers and unioned with
+ * the concurrent union. the sets come out the same either way since
+ * the root of a set is always its smallest name
  * 
  */
 unsigned int FindLiveRanges(Arena uf_arena)
@@ -324,58 +674,106 @@ unsigned int FindLiveRanges(Arena uf_arena)
     Remat::remat_sets = UFSet_Create(SSA_def_count);
   }
 
+  //gather the phi nodes so they can be handed out to the workers
+  PhiWork work;
   Block* b;
   Phi_Node* phi;
-  UFSet* set;
-  unsigned int liverange_count = SSA_def_count;
   ForAllBlocks(b)
   {
-    //visit each phi node and union the parameters and destination
-    //register together since they should all be part of the same live
-    //range
     Block_ForAllPhiNodes(phi, b)
     {
-      debug("process phi: %d at %s (%d)", phi->new_name, bname(b), bid(b));
-      Variable* v_ptr;
-      //find current sets for the phi node
-      set = Find_Set(phi->new_name);
+      work.phis.push_back(phi);
+    }
+  }
+  Unsigned_Int workers = Parallel::NumWorkers(work.phis.size());
+  work.concurrent = (workers > 1);
+  work.merged.assign(workers, 0);
+  work.remat_splits.resize(workers);
+  Parallel::ForRange(work.phis.size(), UnionPhisRange, &work);
+
+  unsigned int liverange_count = SSA_def_count;
+  for(Unsigned_Int w = 0; w < workers; w++)
+  {
+    liverange_count -= work.merged[w];
+    for(unsigned int i = 0; i < work.remat_splits[w].size(); i++)
+    {
+      Remat::AddSplit(work.remat_splits[w][i].first, 
+                      work.remat_splits[w][i].second);
+    }
+  }
 
-      Phi_Node_ForAllParms(v_ptr, phi)
+  return liverange_count;
+}
+
+/*
+ *=============================
+ * UnionPhisRange()
+ *=============================
+ * Parallel::Work that unions the parameters and destination of a
+ * slice of the phi nodes since they should all be part of the same
+ * live range
+ *
+ ***/
+void UnionPhisRange(void* arg, Unsigned_Int lo, Unsigned_Int hi,
+                    Unsigned_Int worker)
+{
+  PhiWork* work = static_cast<PhiWork*>(arg);
+  for(Unsigned_Int i = lo; i < hi; i++)
+  {
+    Phi_Node* phi = work->phis[i];
+    debug("process phi: %d", phi->new_name);
+    Variable* v_ptr;
+    Phi_Node_ForAllParms(v_ptr, phi)
+    {
+      Variable v = *v_ptr;
+      if(v != 0)
       {
-        Variable v = *v_ptr;
-        if(v != 0)
+        //union sets together unless they are alredy part of the
+        //same live range
+        if(UnionNames(uf_sets, phi->new_name, v, work->concurrent))
         {
-          //union sets together unless they are alredy part of the
-          //same live range
-          if(set != Find_Set(v))
+          work->merged[worker]++;
+          debug("union: %d U %d", phi->new_name, v);
+        }
+
+        if(Params::Algorithm::rematerialize)
+        {
+          //selectively union if using rematerialization
+          if(Remat::tags[v].val == Remat::tags[phi->new_name].val)
           {
-            set = UFSet_Union(set, Find_Set(v));
-            --liverange_count;
-            debug("union: %d U %d = %d(setid)", phi->new_name, v, set->id);
+            debug("live range union ok by remat: %d",v);
+            UnionNames(Remat::remat_sets, phi->new_name, v, 
+                       work->concurrent);
           }
-
-          if(Params::Algorithm::rematerialize)
+          else //split live ranges
           {
-            UFSet* remat_set = Find_Set(phi->new_name, Remat::remat_sets);
-            //selectively union if using rematerialization
-            if(Remat::tags[v].val == Remat::tags[phi->new_name].val)
-            {
-              debug("live range union ok by remat: %d",v);
-              remat_set = 
-                UFSet_Union(remat_set, Find_Set(v, Remat::remat_sets));
-            }
-            else //split live ranges
-            {
-              debug("live range split by remat: %d",v);
-              Remat::AddSplit(phi->new_name, v);
-            }
+            debug("live range split by remat: %d",v);
+            work->remat_splits[worker].push_back(
+              std::make_pair(phi->new_name, v));
           }
         }
       }
     }
   }
+}
 
-  return liverange_count;
+/*
+ *=============================
+ * UnionNames()
+ *=============================
+ * unions the sets of two names and returns true if they were in
+ * different sets
+ *
+ ***/
+bool UnionNames(UFSet* sets, Variable v1, Variable v2, bool concurrent)
+{
+  if(concurrent) return UFSet_UnionConcurrent(sets, v1, v2);
+
+  Variable s1 = Find_Set(v1, sets);
+  Variable s2 = Find_Set(v2, sets);
+  if(s1 == s2) return false;
+  UFSet_Union(sets, s1, s2);
+  return true;
 }
 
 /*
@@ -397,12 +795,11 @@ void BuildInterferences(Arena arena)
   //each of those live ranges will interfere with every other live
   //range in the block. walk through the graph and examine each block
   //to build the live ranges
+  using Operands::Operand;
+
   LiveRange* lr;
   LRID lrid;
   Block* blk;
-  Inst* inst;
-  Operation** op;
-  Unsigned_Int* reg;
   SparseSet lrset = SparseSet_Create(arena, live_ranges.size());
   ForAllBlocks(blk)
   {
@@ -418,32 +815,38 @@ void BuildInterferences(Arena arena)
     //(the name defined by the phi-node for those definitions). as
     //long as we get the last definition in the block we should be ok
     SparseSet_Clear(lrset);
-    Block_ForAllInstsReverse(inst, blk)
+    const Operand* first = Operands::Begin(blk);
+    for(const Operand* inst_end = Operands::End(blk); inst_end != first;)
     {
       //go in reverse because we want the last def that we see to be
       //the orig_name for the live range, this must be so because we
       //use that name in the use-def chains to decide where to put a
       //store for the defs of a live range
-      debug("processing inst:\n%s", Debug::StringOfInst(inst));
-      Inst_ForAllOperations(op, inst)
+      const Operand* inst_start = Operands::InstStart(first, inst_end);
+      for(const Operand* o = inst_start; o != inst_end;)
       {
-        Operation_ForAllDefs(reg, *op)
+        const Operand* op_end = Operands::OpEnd(o, inst_end);
+        for(const Operand* d = o; d != op_end; d++)
         {
-          lrid = SSAName2OrigLRID(*reg);
+          if(d->kind != Operands::DEF_OPERAND) continue;
+          lrid = d->lrid;
           //better not have two definitions in the same block for the
           //same live range
-          assert_same_orig_name(lrid, *reg, lrset, blk); 
-          AddLiveUnitOnce(lrid, blk, lrset, *reg);
-          debug("(def) %d (lrid) as r%d", lrid,*reg);
+          assert_same_orig_name(lrid, d->name, lrset, blk); 
+          AddLiveUnitOnce(lrid, blk, lrset, d->name);
+          debug("(def) %d (lrid) as r%d", lrid, d->name);
         }
 
-        Operation_ForAllUses(reg, *op)
+        for(const Operand* u = o; u != op_end; u++)
         {
-          lrid = SSAName2OrigLRID(*reg);
-          AddLiveUnitOnce(lrid, blk, lrset, *reg);
-          debug("(use) %d (lrid) as r%d", lrid,*reg);
+          if(u->kind != Operands::USE_OPERAND) continue;
+          lrid = u->lrid;
+          AddLiveUnitOnce(lrid, blk, lrset, u->name);
+          debug("(use) %d (lrid) as r%d", lrid, u->name);
         }
-      } 
+        o = op_end;
+      }
+      inst_end = inst_start;
     }
 
     //Now add in the live_out set to the variables that include this
@@ -483,6 +886,90 @@ void BuildInterferences(Arena arena)
   }
 }
 
+/*
+ *============================
+ * RebuildLiveRanges()
+ *============================
+ * Throws away the current live ranges and builds them again from the
+ * union find sets. Used after the sets have been changed by
+ * coalescing.
+ *
+ ***/
+void RebuildLiveRanges(Arena arena, Unsigned_Int num_lrs)
+{
+  Mapping::CreateLiveRangeNameMap(arena);
+  Mapping::CreateLiveRangeTypeMap(arena, num_lrs);
+  Operands::Build();
+  CreateLiveRangesWithStats(num_lrs);
+  BuildInterferences(arena);
+}
+
+/*
+ *============================
+ * ClearEdgeExtensions()
+ *============================
+ * Drops the moved loads and stores hanging off every edge.
+ *
+ ***/
+void ClearEdgeExtensions()
+{
+  Block* b;
+  Edge* e;
+  ForAllBlocks(b)
+  {
+    Block_ForAllPreds(e,b) e->edge_extension = NULL;
+    Block_ForAllSuccs(e,b) e->edge_extension = NULL;
+  }
+}
+
+/*
+ *============================
+ * MarkAllLoadsAndStores()
+ *============================
+ * Marks the loads and stores for every live range. Live ranges are
+ * independent here so they are split across the worker threads, each
+ * with its own scratch block set.
+ *
+ ***/
+void MarkAllLoadsAndStores(Arena arena)
+{
+  using Chow::live_ranges;
+  Unsigned_Int n = live_ranges.size();
+  std::vector<VectorSet> scratch(Parallel::NumWorkers(n));
+  scratch[0] = LiveRange::tmpbbset;
+  for(unsigned int w = 1; w < scratch.size(); w++)
+    scratch[w] = VectorSet_Create(arena, block_count+1);
+
+  Parallel::ForRange(n, MarkLoadsAndStoresRange, &scratch);
+}
+
+void MarkLoadsAndStoresRange(void* arg, Unsigned_Int lo, Unsigned_Int hi,
+                             Unsigned_Int worker)
+{
+  std::vector<VectorSet>& scratch = 
+    *static_cast<std::vector<VectorSet>*>(arg);
+  for(Unsigned_Int i = lo; i < hi; i++)
+    Chow::live_ranges[i]->MarkLoadsAndStores(scratch[worker]);
+}
+
+/*
+ *============================
+ * CreateLiveRangesWithStats()
+ *============================
+ * Computes the block statistics in a scratch arena, creates the live
+ * ranges from them, and then drops the statistics since the live
+ * units keep what they need.
+ *
+ ***/
+void CreateLiveRangesWithStats(Unsigned_Int num_lrs)
+{
+  Arena stats_arena = Arena_Create();
+  Stats::ComputeBBStats(stats_arena, SSA_def_count);
+  CreateLiveRanges(num_lrs);
+  Stats::ReleaseBBStats();
+  Arena_Destroy(stats_arena);
+}
+
 /*
  *============================
  * CreateLiveRanges()
@@ -490,31 +977,32 @@ void BuildInterferences(Arena arena)
  * Allocates space for initial live ranges and sets default values.
  *
  ***/
-void CreateLiveRanges(Arena arena, Unsigned_Int num_lrs)
+void CreateLiveRanges(Unsigned_Int num_lrs)
 {
   using Chow::live_ranges;
   using Chow::live_units;
 
-  //initialize LiveRange class
-  LiveRange::Init(arena, num_lrs);
+  //initialize LiveRange class, dropping the live ranges of any
+  //earlier build
+  LiveRange::Init(num_lrs);
 
   //create initial live ranges
-  live_ranges.resize(num_lrs, NULL); //allocate space for live ranges
+  //the live ranges add themselves to the LRTable that Init() cleared
+  live_units.clear(); //may be rebuilding
   live_units.resize(block_count+1);
   for(unsigned int lrid = 0; lrid < num_lrs; lrid++) 
   {
     LiveRange* lr = 
       new LiveRange(RegisterClass::InitialRegisterClassForLRID(lrid), 
                     lrid,
-                    Mapping::LiveRangeDefType(lrid),
-                    num_lrs);
+                    Mapping::LiveRangeDefType(lrid));
 
     //initialize blockmap here since there should only be one tied to
     //the original live range that is shared by all live ranges split
     //from this one
-    lr->blockmap = new std::map<unsigned int, LiveRange*>;
-    lr->splits = new std::vector<LiveRange*>;
-    live_ranges[lrid] = lr;
+    lr->blockmap = ArenaAlloc::New<BlockMap>();
+    lr->splits = ArenaAlloc::New<SplitVec>();
+    assert(live_ranges[lrid] == lr);
   }
 }
 
@@ -587,36 +1075,67 @@ AddLiveUnitOnce(LRID lrid, Block* b, SparseSet lrset, Variable orig_name)
  * and unconstrained lists so we pass them in for possible
  * modification.
  ***/
-void SplitNeighbors(LiveRange* lr, LRSet* constr_lr, LRSet* unconstr_lr)
+void SplitNeighbors(LiveRange* lr, LRIDSet* constr_lr, LRIDSet* unconstr_lr)
 {
   debug("BEGIN SPLITTING");
   using Stats::chowstats;
   using Params::Algorithm::spill_instead_of_split;
-  using Params::Algorithm::split_limit;
 
   //make a copy of the interference list as a worklist since splitting
   //may add and remove items to the original interference list
-  LRVec worklist(lr->fear_list->size());
-  if(lr->fear_list->size() > 0)
+  std::vector<LRID> worklist;
+  worklist.reserve(lr->fear_list->size());
+  for(LazySet::iterator i = lr->fear_list->begin(); 
+      i != lr->fear_list->end(); 
+      i++)
   {
-    copy(lr->fear_list->begin(), lr->fear_list->end(), worklist.begin());
+    worklist.push_back((*i)->id);
   }
 
-  //our neighbors are the live ranges we interfere with
+  //the neighbors are split in rounds. each round first collects the
+  //neighbors that need a split, then splits them and finally brings
+  //the constrained lists up to date once for every live range touched
+  //in the round. an earlier split in the round can change the neighbor
+  //counts of a later member, so the need to split is checked again
+  //just before each member is split
   while(!worklist.empty())
   {
-    LiveRange* intf_lr = worklist.back(); worklist.pop_back();
-    //only check allocation candidates, may not be a candidate if it
-    //has already been assigned a color
-    if(!(intf_lr->is_candidate)) continue;
+    //our neighbors are the live ranges we interfere with
+    LRVec batch;
+    while(!worklist.empty())
+    {
+      LRID intf_id = worklist.back(); worklist.pop_back();
+      //only check allocation candidates, may not be a candidate if it
+      //has already been assigned a color
+      if(!LRTable::is_candidate[intf_id]) continue;
+      LiveRange* intf_lr = Chow::live_ranges[intf_id];
+
+      //split if no registers available
+      if(ShouldSplitLiveRange(intf_lr))
+      {
+        debug("Need to split LR: %d", intf_lr->id);
+        batch.push_back(intf_lr);
+      }
+    }
 
-    //split if no registers available
-    if(ShouldSplitLiveRange(intf_lr))
+    ListUpdates updates;
+    for(LRVec::size_type i = 0; i < batch.size(); i++)
     {
-      debug("Need to split LR: %d", intf_lr->id);
-      if((split_limit && (int)chowstats.cSplits >= split_limit) ||
-          spill_instead_of_split ||
-          intf_lr->IsEntirelyUnColorable())
+      LiveRange* intf_lr = batch[i];
+      if(i > 0 && !ShouldSplitLiveRange(intf_lr))
+      {
+        debug("LR: %d no longer needs a split", intf_lr->id);
+        continue;
+      }
+      bool must_spill =
+        (class_split_limit >= 0 &&
+         (int)(chowstats.cSplits - class_first_split) >= class_split_limit) ||
+        spill_instead_of_split ||
+        intf_lr->IsEntirelyUnColorable();
+      //only count it as degraded if the deadline is why it is spilled
+      bool out_of_time = !must_spill && Stats::DeadlineExpired();
+      if(out_of_time) chowstats.cDegraded++;
+      if(must_spill || out_of_time)
       {
         debug("LR: %d is uncolorable - will not split", intf_lr->id);
         //delete this live range from the interference graph. update
@@ -624,13 +1143,13 @@ void SplitNeighbors(LiveRange* lr, LRSet* constr_lr, LRSet* unconstr_lr)
         //after we delete this from the interference graph
         intf_lr->MarkNonCandidateAndDelete(); chowstats.cSpills++;
         UpdateConstrainedListsAfterDelete(intf_lr, constr_lr, unconstr_lr);
+        updates.erase(intf_lr->id);
       }
       else //try to split
       {
         //Split() returns the new live range that we know is colorable
         LiveRange* newlr = intf_lr->Split();
-        //add new liverange to list of live ranges
-        Chow::live_ranges.push_back(newlr);
+        //the new live range is in the LRTable and so in live_ranges
         assert(newlr->id == (Chow::live_ranges.size() - 1));
         debug("ADDED LR: %d", newlr->id);
 
@@ -638,26 +1157,12 @@ void SplitNeighbors(LiveRange* lr, LRSet* constr_lr, LRSet* unconstr_lr)
         {
           intf_lr->MarkNonCandidateAndDelete(); chowstats.cZeroOccurrence++;
           UpdateConstrainedListsAfterDelete(intf_lr, constr_lr, unconstr_lr);
-          if(Params::Algorithm::optimistic && !newlr->IsConstrained())
-            PullNodeFromGraph(newlr, constr_lr);
-          else
-            AddToCorrectConstrainedList(constr_lr, unconstr_lr, newlr);
+          updates.erase(intf_lr->id);
+          updates[newlr->id] |= UPDATE_NEW;
         }
         else
         {
-          //make sure constrained lists are up-to-date after split
-          UpdateConstrainedLists(newlr, intf_lr, constr_lr, unconstr_lr);
-          //if the remainder of the live range we just split from
-          //interferes with the live range we assigned a color to then 
-          //add it to the work list because it may need to be split more
-          if(intf_lr->InterferesWith(lr))
-          {
-            if(!Params::Algorithm::optimistic  ||
-               (Params::Algorithm::optimistic && !intf_lr->simplified))
-            {
-                    worklist.push_back(intf_lr);
-            }
-          }
+          NoteSplit(newlr, intf_lr, &updates);
         }
 
         debug("split complete for LR: %d", intf_lr->id);
@@ -665,6 +1170,23 @@ void SplitNeighbors(LiveRange* lr, LRSet* constr_lr, LRSet* unconstr_lr)
         Debug::LiveRange_DDump(newlr);
       }
     }
+    ApplyListUpdates(updates, constr_lr, unconstr_lr);
+
+    //if the remainder of a live range we just split from still
+    //interferes with the live range we assigned a color to then it
+    //goes in the next round because it may need to be split more
+    for(LRVec::size_type i = 0; i < batch.size(); i++)
+    {
+      LiveRange* intf_lr = batch[i];
+      if(intf_lr->is_candidate() && intf_lr->InterferesWith(lr))
+      {
+        if(!Params::Algorithm::optimistic  ||
+           (Params::Algorithm::optimistic && !intf_lr->simplified()))
+        {
+          worklist.push_back(intf_lr->id);
+        }
+      }
+    }
   }
   debug("DONE SPLITTING");
 } 
@@ -672,78 +1194,84 @@ void SplitNeighbors(LiveRange* lr, LRSet* constr_lr, LRSet* unconstr_lr)
 
 /*
  *================================
- * UpdateConstrainedLists()
+ * NoteSplit()
  *================================
- * Makes sure that the live ranges are in the constrained lists if
- * they are constrained. This is used to update the lists after a live
- * range split for the live ranges that interfere with both the old
- * and the new live range.
+ * Records the constrained list changes a split needs. The new and
+ * original live range must be placed in the right list, and the
+ * live ranges that interfere with both of them may have become
+ * constrained. Those are the only live ranges whose status can
+ * change.
  *
  ***/
-void UpdateConstrainedLists(LiveRange* newlr, 
-                            LiveRange* origlr,
-                            LRSet* constr_lrs, 
-                            LRSet* unconstr_lrs)
+void NoteSplit(LiveRange* newlr, LiveRange* origlr, ListUpdates* updates)
 {
-  //if optimistic
-  //if origlr is no longer constraiend then remove from constraiend
-  //and pull the node out of the graph. next check what needs to be
-  //done with the new live range.
-  if(Params::Algorithm::optimistic)
-  {
-    if(!origlr->IsConstrained())
-    {
-      constr_lrs->erase(origlr);
-      PullNodeFromGraph(origlr, constr_lrs);
-    }
-    if(newlr->IsConstrained())
-    {
-      constr_lrs->insert(newlr);
-    }
-    else
-    {
-      PullNodeFromGraph(newlr, constr_lrs);
-    }
+  (*updates)[newlr->id] |= UPDATE_NEW;
+  (*updates)[origlr->id] |= UPDATE_SHRUNK;
 
-    return; //exit early
-  }
+  //the optimistic allocator only pulls the split live ranges
+  if(Params::Algorithm::optimistic) return;
 
-  //update constrained lists, only need to update for any live range
-  //that interferes with both the new and original live range because
-  //those are the only live ranges that could have changed status
-  /*LRSet updates;
-  set_intersection(newlr->fear_list->begin(), newlr->fear_list->end(),
-                   origlr->fear_list->begin(), origlr->fear_list->end(),
-                   inserter(updates,updates.begin()));
-  for(LRSet::iterator i = updates.begin(); i != updates.end(); i++)
-  */
   for(LazySet::iterator i = newlr->fear_list->begin(); 
       i != newlr->fear_list->end(); 
       i++)
   {
-
     LiveRange* lr = *i;
-    if(origlr->fear_list->member(lr))
-    {
-      //skip anyone that has already been assigned a color
-      if(!lr->is_candidate) continue;
+    //skip anyone that has already been assigned a color
+    if(lr->is_candidate() && origlr->fear_list->member(lr))
+      (*updates)[lr->id] |= UPDATE_PROMOTE;
+  }
+}
+
+/*
+ *================================
+ * ApplyListUpdates()
+ *================================
+ * Moves each live range recorded in a round of splits to the list
+ * that matches its final status. Every live range is looked at once
+ * and in id order no matter how many splits touched it.
+ *
+ ***/
+void ApplyListUpdates(const ListUpdates& updates,
+                      LRIDSet* constr_lrs, 
+                      LRIDSet* unconstr_lrs)
+{
+  using Params::Algorithm::optimistic;
+  for(ListUpdates::const_iterator i = updates.begin(); 
+      i != updates.end(); i++)
+  {
+    LRID id = i->first;
+    int what = i->second;
+    if(!LRTable::is_candidate[id]) continue;
 
-      if(lr->IsConstrained())
+    LiveRange* lr = Chow::live_ranges[id];
+    if(lr->IsConstrained())
+    {
+      if(what & UPDATE_NEW)
       {
-        debug("ensuring LR: %d is in constr", lr->id);
-        unconstr_lrs->erase(lr);
-        constr_lrs->insert(lr);
+        debug("Constrained LR:    %d", id);
+        constr_lrs->insert(id);
+      }
+      else if((what & UPDATE_PROMOTE) && unconstr_lrs->erase(id))
+      {
+        debug("ensuring LR: %d is in constr", id);
+        constr_lrs->insert(id);
+      }
+    }
+    else
+    {
+      if(what & UPDATE_NEW)
+      {
+        debug("UN-Constrained LR:    %d", id);
+        if(optimistic) PullNodeFromGraph(lr, constr_lrs);
+        else unconstr_lrs->insert(id);
+      }
+      else if((what & UPDATE_SHRUNK) && constr_lrs->erase(id))
+      {
+        debug("shifting LR: %d to unconstrained", id);
+        if(optimistic) PullNodeFromGraph(lr, constr_lrs);
+        else unconstr_lrs->insert(id);
       }
     }
-  }
-
-  //also, need to update the new and original live range positions
-  AddToCorrectConstrainedList(constr_lrs, unconstr_lrs, newlr);
-  if(!origlr->IsConstrained())
-  {
-    debug("shifting LR: %d to unconstrained", origlr->id);
-    constr_lrs->erase(origlr);
-    unconstr_lrs->insert(origlr);
   }
 }
 
@@ -756,8 +1284,8 @@ void UpdateConstrainedLists(LiveRange* newlr,
  * bucket.
  ***/
 void UpdateConstrainedListsAfterDelete(LiveRange* lr,
-                                        LRSet* constr_lrs, 
-                                        LRSet* unconstr_lrs)
+                                        LRIDSet* constr_lrs, 
+                                        LRIDSet* unconstr_lrs)
 {
   for(LazySet::iterator i = lr->fear_list->begin(); 
       i != lr->fear_list->end(); 
@@ -765,24 +1293,24 @@ void UpdateConstrainedListsAfterDelete(LiveRange* lr,
   {
     LiveRange* fear_lr = *i;
     //skip anyone that has already been assigned a color
-    if(!(fear_lr)->is_candidate) continue;
+    if(!(fear_lr)->is_candidate()) continue;
     if((fear_lr)->IsConstrained())
     {
-      if(unconstr_lrs->erase(fear_lr))
-        constr_lrs->insert(fear_lr);
+      if(unconstr_lrs->erase(fear_lr->id))
+        constr_lrs->insert(fear_lr->id);
     }
     else
     {
-      if(constr_lrs->erase(fear_lr)) 
+      if(constr_lrs->erase(fear_lr->id)) 
       {
         if(Params::Algorithm::optimistic)
           PullNodeFromGraph(fear_lr, constr_lrs);
         else
-          unconstr_lrs->insert(fear_lr);
+          unconstr_lrs->insert(fear_lr->id);
       }
     }
   }
-  constr_lrs->erase(lr);
+  constr_lrs->erase(lr->id);
 }
 
 /*
@@ -1071,7 +1599,7 @@ void MoveLoadsAndStores()
 
 void HandleCopyDefs()
 {
-  typedef std::list<MovedSpillDescription>::iterator LI;
+  typedef SpillList::iterator LI;
   Block* blk;
 
   ForAllBlocks(blk)
@@ -1104,21 +1632,13 @@ void HandleCopyDefs()
             //succssor live range.
             LiveRange* lr = msd.lr_dest;
 
-            //interset the blocks that the def would reach with this
-            //live ranges blocks to limit our scope
-            VectorSet_Intersect(
-              LiveRange::tmpbbset, 
-              Reach::ReachableBlocks(edg->succ),
-              lr->bb_list
-            );
-
-            //check all the blocks the def would reach to see if a
-            //store is necessary
+            //check all the blocks of this live range that the def
+            //would reach to see if a store is necessary
+            VectorSet reach = Reach::ReachableBlocks(edg->succ);
             for(LiveRange::iterator it = lr->begin(); it != lr->end(); it++)
             {
               LiveUnit* unit = *it;
-              if(!VectorSet_Member(LiveRange::tmpbbset, bid(unit->block)))
-                continue;
+              if(!VectorSet_Member(reach, bid(unit->block))) continue;
 
               //check all the succesor blocks to find any exits of the
               //live range and insert a store if they are live in at
@@ -1145,7 +1665,7 @@ void HandleCopyDefs()
                       }
                     }
                   }
-                  if(!existing_store && LiveIn(lr->orig_lrid, blkSucc))
+                  if(!existing_store && Liveness::LiveIn(lr->orig_lrid, blkSucc))
                   {
                     MovedSpillDescription msd_store = {0};
                     msd_store.lr = lr;
@@ -1166,38 +1686,25 @@ void HandleCopyDefs()
     }//ForAllSuccs
   }//ForAllBlocks
 }
-bool LiveIn(LRID orig_lrid, Block* blk)
-{
-  Liveness_Info info = SSA_live_in[bid(blk)];
-  for(LOOPVAR j = 0; j < info.size; j++)
-  {
-    if(orig_lrid == info.names[j])
-    {
-      return true;
-    }
-  }
-  return false;
-}
-
 bool ShouldSplitLiveRange(LiveRange* lr)
 {
   debug("should split LR: %d ?", lr->id);
-  if(Params::Algorithm::optimistic && lr->simplified) return false;
-  return (*Chow::Heuristics::when_to_split_strategy)(lr);
+  if(Params::Algorithm::optimistic && lr->simplified()) return false;
+  return Chow::Heuristics::ShouldSplit(lr);
 }
 
-inline void AddToCorrectConstrainedList(LRSet* constr_lrs, 
-                                        LRSet* unconstr_lrs,
+inline void AddToCorrectConstrainedList(LRIDSet* constr_lrs, 
+                                        LRIDSet* unconstr_lrs,
                                         LiveRange* lr)
 {
   if(lr->IsConstrained())
   {
-    constr_lrs->insert(lr);
+    constr_lrs->insert(lr->id);
     debug("Constrained LR:    %d", lr->id);
   }
   else
   {
-    unconstr_lrs->insert(lr);
+    unconstr_lrs->insert(lr->id);
     debug("UN-Constrained LR:    %d", lr->id);
   }
 }
@@ -1275,10 +1782,12 @@ void CountLocals()
 /****************************************************************
  *                     OPTIMISTIC CHOW
  ****************************************************************/
-void SimplifyGraph(LRSet* constr_lrs);
+void SimplifyGraph(LRIDSet* constr_lrs);
 void ColorFromStack();
-void PullNodesFromGraph(std::list<LiveRange*>&, LRSet* constr_lrs, LRSet* init=NULL);
-void SeparateConstrainedLiveRanges(LRSet* constr_lrs, LRSet* unconstr_lrs)
+void PullNodesFromGraph(std::list<LiveRange*>&, LRIDSet* constr_lrs,
+                        LRIDSet* init=NULL);
+void SeparateConstrainedLiveRanges(LRIDSet* constr_lrs,
+                                   LRIDSet* unconstr_lrs)
 {
   using Chow::live_ranges;
 
@@ -1300,7 +1809,7 @@ void SeparateConstrainedLiveRanges(LRSet* constr_lrs, LRSet* unconstr_lrs)
   }
 }
 
-void ColorUnconstrained(LRSet* unconstr_lrs)
+void ColorUnconstrained(LRIDSet* unconstr_lrs)
 {
   using Params::Algorithm::allocate_all_unconstrained;
 
@@ -1310,22 +1819,22 @@ void ColorUnconstrained(LRSet* unconstr_lrs)
   }
   else
   {
-    for(LRSet::iterator i = 
+    for(LRIDSet::iterator i = 
         unconstr_lrs->begin(); i != unconstr_lrs->end(); i++)
     {
-      LiveRange* lr = *i;
+      LiveRange* lr = Chow::live_ranges[*i];
 
       debug("choose color for unconstrained LR: %d", lr->id);
-      assert(lr->is_candidate);
+      assert(lr->is_candidate());
       if(allocate_all_unconstrained || (lr->GetPriority() > 0))
       {
         lr->AssignColor();
-        debug("LR: %d is given color:%d", lr->id, lr->color);
+        debug("LR: %d is given color:%d", lr->id, lr->color());
       }
       else
       {
         debug("LR: %d is has bad priority: %.3f, no color given",
-              lr->id, lr->priority);
+              lr->id, lr->priority());
         lr->MarkNonCandidateAndDelete();
         Stats::chowstats.cSpills++;
       }
@@ -1333,13 +1842,13 @@ void ColorUnconstrained(LRSet* unconstr_lrs)
   }
 }
 
-void SimplifyGraph(LRSet* constr_lrs)
+void SimplifyGraph(LRIDSet* constr_lrs)
 {
   using Chow::live_ranges;
   using Chow::color_stack;
 
   std::list<LiveRange*> worklist;
-  LRSet pulled;
+  LRIDSet pulled;
 
   //pull out initial unconstrained live ranges
   for(LRVec::size_type i = 1; i < live_ranges.size(); i++)
@@ -1351,7 +1860,7 @@ void SimplifyGraph(LRSet* constr_lrs)
       {
         debug("initial unconstrained LR: %d", lr->id);
         worklist.push_back(lr);
-        pulled.insert(lr);
+        pulled.insert(lr->id);
       }
       else
       {
@@ -1370,12 +1879,12 @@ void SimplifyGraph(LRSet* constr_lrs)
     if(lr->IsConstrained())
     {
       debug("CONSTR: LR: %d", lr->id);
-      constr_lrs->insert(lr);
+      constr_lrs->insert(lr->id);
     }
   }
 }
 
-void PullNodeFromGraph(LiveRange* lr, LRSet* constr_lrs)
+void PullNodeFromGraph(LiveRange* lr, LRIDSet* constr_lrs)
 {
   std::list<LiveRange*> worklist;
   worklist.push_back(lr);
@@ -1384,26 +1893,25 @@ void PullNodeFromGraph(LiveRange* lr, LRSet* constr_lrs)
 
 void PullNodesFromGraph(
  std::list<LiveRange*>& worklist,
- LRSet* constr_lrs,
- LRSet* initial_pulled
+ LRIDSet* constr_lrs,
+ LRIDSet* initial_pulled
 )
 {
-  typedef LRSet::iterator LRSI;
   typedef std::list<LiveRange*>::iterator LI;
-  static LRSet pulled;
+  static LRIDSet pulled;
   if(initial_pulled) { pulled = *initial_pulled;}
   else 
   {
     for(LI i = worklist.begin(); i != worklist.end();) 
     {
       debug("checking pull worklist LR: %d", (*i)->id);
-      if((*i)->simplified)
+      if((*i)->simplified())
       {
         debug("lr has already been pulled from the graph");
         LI del = i++;
         worklist.erase(del);
       }
-      else {pulled.insert(*i); i++;}
+      else {pulled.insert((*i)->id); i++;}
     }
   }
 
@@ -1414,9 +1922,9 @@ void PullNodesFromGraph(
     //remove from graph and add any neighbors that can now be removed
     LiveRange* lr = worklist.back(); worklist.pop_back();
     debug("pulling LR: %d from graph", lr->id);
-    assert(!lr->simplified);
+    assert(!lr->simplified());
     Chow::color_stack.push(lr);
-    lr->simplified = true;
+    lr->simplified() = TRUE;
 
     //pull any neighbors that become unconstrained when this node is
     //removed
@@ -1426,13 +1934,13 @@ void PullNodesFromGraph(
       fear_lr->simplified_neighbor_count++;
       fear_lr->simplified_width += RegisterClass::RegWidth(lr->type);
 
-      if(fear_lr->is_candidate &&
+      if(fear_lr->is_candidate() &&
         !fear_lr->IsConstrained() && 
-        (pulled.find(fear_lr) == pulled.end()))
+        (pulled.find(fear_lr->id) == pulled.end()))
       {
         debug("pulling additional unconstrained LR: %d", fear_lr->id);
-        pulled.insert(fear_lr);
-        constr_lrs->erase(fear_lr);
+        pulled.insert(fear_lr->id);
+        constr_lrs->erase(fear_lr->id);
         worklist.push_back(fear_lr);
         Stats::chowstats.cFoundOptimist++;
       }
@@ -1448,7 +1956,7 @@ void ColorFromStack()
   {
     LiveRange* lr = color_stack.top(); color_stack.pop();
     debug("assigning color for unconstrained LR: %d", lr->id);
-    if(Coloring::NumColorsAvailable(lr, lr->forbidden) > 0)
+    if(Coloring::IsColorAvailable(lr))
     {
       if(allocate_all_unconstrained || (lr->GetPriority() > 0))
       {
@@ -11,8 +11,9 @@
 #include "types.h"
 
 struct LiveRange;
+struct LiveRangeView; /* see live_range.h */
 namespace Chow {
-  extern std::vector<LiveRange*> live_ranges;
+  extern LiveRangeView live_ranges;
   extern std::vector<std::vector<LiveUnit*> > live_units;
   extern std::map<Variable,bool> local_names;
   extern Arena arena;
@@ -22,6 +22,7 @@
 #include "reach.h"
 #include "heuristics.h"
 #include "cfg_tools.h"
+#include "result_cache.h"
 
 /*------------------MODULE LOCAL DEFINITIONS-------------------*/
 /*#### module types ####*/
@@ -31,7 +32,8 @@ typedef enum
   INT_PARAM,
   FLOAT_PARAM,
   BOOL_PARAM,
-  INT_ARRAY_PARAM
+  INT_ARRAY_PARAM,
+  STRING_PARAM
 } Param_Type;
 
 /* index for help messages */
@@ -53,7 +55,17 @@ typedef enum
   HELP_TRIMUSELESS,
   HELP_COLORCHOICESTRATEGY,
   HELP_SPLITINCLUDESTRATEGY,
-  HELP_SPLITWHENSTRATEGY
+  HELP_SPLITWHENSTRATEGY,
+  HELP_SPLITHOWSTRATEGY,
+  HELP_COALESCECOPIES,
+  HELP_CALLEESAVED,
+  HELP_LINEARSCANBLOCKS,
+  HELP_DEADLINE,
+  HELP_THREADS,
+  HELP_SPLITCANDIDATES,
+  HELP_RESULTCACHEDIR,
+  HELP_RESULTCACHESIZE,
+  HELP_LEANOUTPUT
 } Param_Help;
 
 
@@ -78,8 +90,9 @@ static int process_locals(Param_Details* param, char* arg);
 static const char* get_usage(Param_Help idx);
 static void usage(bool);
 static void Param_InitDefaults(void);
-static void DumpParamTable(FILE* =stderr);
+static void DumpParamTable(FILE* =stderr, const char* skip ="");
 static void Output(void);
+static void InitResultCache(const char* input_file);
 static void EnforceParameterConsistency();
 static void CheckRegisterLimitFeasibility(Arena);
 static void SetupMachineParams(Arena arena);
@@ -91,6 +104,9 @@ static inline int max(int a, int b) { return a > b ? a : b;}
 static const int SUCCESS = 0;
 static const int ERROR = -1;
 static const char EMPTY_NAME = '\0';
+/* the allocated code goes out through one large buffer */
+static const size_t OUTPUT_BUFFER_BYTES = 1 << 20;
+static char output_buffer[OUTPUT_BUFFER_BYTES];
 static std::map<Variable,Variable> orig_ssa_name_map;
 
 /* define these values to "block out" useless columns in the param
@@ -113,6 +129,7 @@ static const bool    B = false;
 using Params::Machine::num_registers;
 using Params::Machine::enable_register_classes;
 using Params::Machine::num_register_classes;
+using Params::Machine::num_callee_saved;
 using Params::Algorithm::bb_max_insts;
 using Params::Algorithm::loop_depth_weight;
 using Params::Algorithm::move_loads_and_stores;
@@ -131,8 +148,16 @@ using Params::Algorithm::enhanced_register_promotion;
 using Params::Algorithm::prefer_clean_locals;
 using Params::Algorithm::split_limit;
 using Params::Algorithm::priority_function;
+using Params::Algorithm::coalesce_copies;
+using Params::Algorithm::linear_scan_blocks;
+using Params::Algorithm::deadline_msecs;
+using Params::Algorithm::num_threads;
+using Params::Algorithm::split_candidates;
 using Params::Program::force_minimum_register_count;
 using Params::Program::dump_params_only;
+using Params::Program::result_cache_dir;
+using Params::Program::result_cache_mb;
+using Params::Program::lean_output;
 static Param_Details param_table[] = 
 {
   {'b', process_, bb_max_insts,F,B, &bb_max_insts,
@@ -163,7 +188,7 @@ static Param_Details param_table[] =
   {'w', process_heuristic, when_to_split,F,B,&when_to_split,
          INT_PARAM, HELP_SPLITWHENSTRATEGY},
   {'s', process_heuristic, how_to_split,F,B,&how_to_split,
-         INT_PARAM, NO_HELP},
+         INT_PARAM, HELP_SPLITHOWSTRATEGY},
   {'l', process_locals,num_register_classes,F,B,num_reserved_registers,
          INT_ARRAY_PARAM, NO_HELP},
   {'g', process_, I,F,allocate_locals, &allocate_locals,
@@ -178,10 +203,28 @@ static Param_Details param_table[] =
          &prefer_clean_locals, BOOL_PARAM, NO_HELP},
   {'u', process_, split_limit,F,B, &split_limit, INT_PARAM, NO_HELP},
   {'x', process_heuristic, priority_function,F,B,&priority_function,
-         INT_PARAM, NO_HELP}
+         INT_PARAM, NO_HELP},
+  {'v', process_, I,F,coalesce_copies, &coalesce_copies,
+         BOOL_PARAM, HELP_COALESCECOPIES},
+  {'j', process_, num_callee_saved,F,B, &num_callee_saved,
+         INT_PARAM, HELP_CALLEESAVED},
+  {'q', process_, linear_scan_blocks,F,B, &linear_scan_blocks,
+         INT_PARAM, HELP_LINEARSCANBLOCKS},
+  {'h', process_, deadline_msecs,F,B, &deadline_msecs,
+         INT_PARAM, HELP_DEADLINE},
+  {'P', process_, num_threads,F,B, &num_threads,
+         INT_PARAM, HELP_THREADS},
+  {'S', process_, split_candidates,F,B, &split_candidates,
+         INT_PARAM, HELP_SPLITCANDIDATES},
+  {'R', process_, I,F,B, &result_cache_dir,
+         STRING_PARAM, HELP_RESULTCACHEDIR},
+  {'M', process_, result_cache_mb,F,B, &result_cache_mb,
+         INT_PARAM, HELP_RESULTCACHESIZE},
+  {'L', process_, I,F,lean_output,&lean_output,
+         BOOL_PARAM, HELP_LEANOUTPUT}
 };
 const unsigned int NPARAMS = (sizeof(param_table) / sizeof(param_table[0]));
-const char* PARAMETER_STRING  = ":b:r:d:c:i:w:s:l:u:x:mpefyztgoank";
+const char* PARAMETER_STRING  = ":b:r:d:c:i:w:s:l:u:x:j:q:h:P:S:R:M:mpefyztgoankvL";
 
 /*--------------------BEGIN IMPLEMENTATION---------------------*/
 /*
@@ -244,6 +287,12 @@ int main(Int argc, Char **argv)
 
   //assumes file is in first argument after the params
   Stats::program_timer.Start();
+  InitResultCache(optind < argc ? argv[optind] : NULL);
+  if(ResultCache::Replay())
+  {
+    return EXIT_SUCCESS;
+  }
+
   if (optind < argc)
     Block_Init(argv[optind]);
   else
@@ -279,8 +328,9 @@ int main(Int argc, Char **argv)
 
   //dump input paramerters and allocation stats
   Stats::program_timer.Stop();
-  DumpParamTable();
-  Stats::DumpAllocationStats();
+  DumpParamTable(ResultCache::StatsFile());
+  Stats::DumpAllocationStats(ResultCache::StatsFile());
+  ResultCache::Finish();
 
   return EXIT_SUCCESS;
 } /* main */
@@ -311,11 +361,35 @@ void Param_InitDefaults()
  *========
  * Output
  *========
- *
+ * writes the allocated code through one large buffer so a big
+ * procedure goes out in few writes
  ***/
 void Output()
 {
-  Block_Put_All(stdout);
+  FILE* out = ResultCache::OutputFile();
+  setvbuf(out, output_buffer, _IOFBF, OUTPUT_BUFFER_BYTES);
+  Block_Put_All(out);
+  fflush(out);
+}
+
+/*
+ *===================
+ * InitResultCache()
+ *===================
+ * the result cache is keyed by the input and by the parameter table
+ * exactly as DumpParamTable() prints it, less the parameters that can
+ * not change the result: the cache itself and the thread count
+ ***/
+void InitResultCache(const char* input_file)
+{
+  char* params = NULL;
+  size_t params_len = 0;
+  FILE* fp = open_memstream(&params, &params_len);
+  if(fp == NULL) return;
+  DumpParamTable(fp, "RMP");
+  fclose(fp);
+  ResultCache::Init(input_file, params, params_len);
+  free(params);
 }
 
 
@@ -347,6 +421,9 @@ int process_(Param_Details* param, char* arg)
       case BOOL_PARAM:
         *((bool*)(param->value)) = param->bdefault;
         break;
+      case STRING_PARAM:
+        *((char**)(param->value)) = NULL;
+        break;
       default:
         error("unknown type");
         abort();
@@ -365,6 +442,9 @@ int process_(Param_Details* param, char* arg)
       case BOOL_PARAM:
         *((bool*)(param->value)) = !(param->bdefault);
         break;
+      case STRING_PARAM:
+        *((char**)(param->value)) = arg;
+        break;
       default:
         error("unknown type");
         abort();
@@ -507,6 +587,41 @@ static const char* get_usage(Param_Help idx)
       return "         rematerialize values instead of spilling";
     case HELP_TRIMUSELESS:
       return "         trim useless blocks after splitting";
+    case HELP_SPLITHOWSTRATEGY:
+      return "[int]    how a split grows from its first block\n"
+             "           0: down through successors (chow)\n"
+             "           1: up and down through successors and predecessors\n"
+             "           2: one loop at a time, deepest loop first, leaving\n"
+             "              a loop only once it is claimed";
+    case HELP_COALESCECOPIES:
+      return "         coalesce copies before allocation";
+    case HELP_CALLEESAVED:
+      return "[int]    number of callee saved registers in each class\n"
+             "           (0 ignores the cost of values live across calls)";
+    case HELP_LINEARSCANBLOCKS:
+      return "[int]    use linear scan for procedures with at least this\n"
+             "           many blocks (0 never, 1 always)";
+    case HELP_DEADLINE:
+      return "[int]    time budget for allocation in milliseconds. when it\n"
+             "           runs out the remaining live ranges are colored if\n"
+             "           possible or spilled. shared out between the\n"
+             "           register classes (0 for no limit)";
+    case HELP_THREADS:
+      return "[int]    threads used for the per live range analyses\n"
+             "           (1 runs everything on the main thread)";
+    case HELP_SPLITCANDIDATES:
+      return "[int]    split points tried for each split. the one giving\n"
+             "           the new live range the best priority is kept\n"
+             "           (1 takes the first suitable split point)";
+    case HELP_RESULTCACHEDIR:
+      return "[dir]    cache allocation results in this directory and\n"
+             "           replay them for the same file and parameters";
+    case HELP_RESULTCACHESIZE:
+      return "[int]    size limit of the result cache in megabytes. the\n"
+             "           least recently used results are removed first";
+    case HELP_LEANOUTPUT:
+      return "         leave the diagnostic comments off inserted loads,\n"
+             "           stores, copies and rematerializations";
 
     default:
       return "         NO HELP AVAILABLE";
@@ -517,15 +632,16 @@ static const char* get_usage(Param_Help idx)
  *==================
  * DumpParamTable()
  *==================
- *
+ * prints the value of every parameter not named in skip
  ***/
-void DumpParamTable(FILE* outfile)
+void DumpParamTable(FILE* outfile, const char* skip)
 {
   LOOPVAR i;
   Param_Details param;
   for(i = 0; i < NPARAMS; i++)
   {
     param = param_table[i];
+    if(strchr(skip, param.name) != NULL) continue;
     fprintf(outfile, "%c: ", param.name);
     switch(param.type)
     {
@@ -538,6 +654,12 @@ void DumpParamTable(FILE* outfile)
       case BOOL_PARAM:
         fprintf(outfile, "%s", *((bool*)param.value) ? "true":"false" );
         break;
+      case STRING_PARAM:
+      {
+        char* str = *((char**)param.value);
+        fprintf(outfile, "%s", str != NULL ? str : "");
+        break;
+      }
       case INT_ARRAY_PARAM: /* here idefault is the array size */
         fprintf(outfile, "[");
         for(int i = 0; i < param.idefault; i++)
@@ -723,7 +845,7 @@ void DataFlowAnalysis(Arena arena)
     FindLocalOnlyNames(arena); 
   }
 
-  Reach::ComputeReachability(arena);
+  Reach::ComputeReachability();
 }
 
 void FindLocalOnlyNames(Arena arena)
@@ -170,16 +170,17 @@ void EnhancedCodeMotion(Edge* edg, Block* blkLD)
  * Attempts to trim away blocks that serve no purpose in the live
  * range. these blocks come up after splitting a live range. there can
  * be dangling blocks that are not part of a path that reaches a use
- * or a def and thus serve no purpose.
+ * or a def and thus serve no purpose. if +to+ is given the useless
+ * blocks are moved to that live range instead of being dropped.
 */ 
 enum TrimDirection{UP, DOWN};
-void Trim(LiveRange* lr, TrimDirection td);
-void Trim(LiveRange* lr)
+void Trim(LiveRange* lr, TrimDirection td, LiveRange* to);
+void Trim(LiveRange* lr, LiveRange* to)
 {
-  Trim(lr, UP);
-  Trim(lr, DOWN);
+  Trim(lr, UP, to);
+  Trim(lr, DOWN, to);
 }
-void Trim(LiveRange* lr, TrimDirection td)
+void Trim(LiveRange* lr, TrimDirection td, LiveRange* to)
 {
   std::queue<LiveUnit*> worklist;
   for(LiveRange::iterator i = lr->begin(); i != lr->end(); i++)
@@ -235,7 +236,8 @@ void Trim(LiveRange* lr, TrimDirection td)
 
     if(!lu->mark)
     {
-      lr->RemoveLiveUnit(lu); 
+      if(to) lr->TransferLiveUnitTo(to, lu);
+      else   lr->RemoveLiveUnit(lu); 
           //better be a list or i++ could be invalid
     }
   }
@@ -257,8 +259,8 @@ Edge_Extension* AddEdgeExtensionNode(Edge* e, MovedSpillDescription msd)
   {
     //create and add the edge extension
     ee = (Edge_Extension*) 
-      Arena_GetMemClear(Chow::arena, sizeof(Edge_Extension));
-    ee->spill_list = new std::list<MovedSpillDescription>;
+      Arena_GetMemClear(LiveRange::arena, sizeof(Edge_Extension));
+    ee->spill_list = ArenaAlloc::New<SpillList>();
     edgPred->edge_extension = ee;
   }
   ee->spill_list->push_back(msd);
@@ -16,7 +16,7 @@ namespace Chow
   namespace Extensions
   {
     void EnhancedCodeMotion(Edge*, Block*);
-    void Trim(LiveRange*);
+    void Trim(LiveRange*, LiveRange* to = NULL);
     Edge_Extension* AddEdgeExtensionNode(Edge*, MovedSpillDescription);
   }
 }
@@ -0,0 +1,214 @@
+/* coalesce.cc
+ *
+ * conservative coalescing of copy related live ranges. the
+ * interference graph built by chow is used to decide which copies can
+ * be removed. coalesced names are unioned into the same sets used to
+ * find the initial live ranges so the live ranges can be rebuilt with
+ * the copies folded away.
+ */
+
+/*-----------------------MODULE INCLUDES-----------------------*/
+#include <SSA.h>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "coalesce.h"
+#include "chow.h"
+#include "live_range.h"
+#include "live_unit.h"
+#include "mapping.h"
+#include "union_find.h"
+#include "rematerialize.h"
+#include "params.h"
+#include "rc.h"
+#include "operands.h"
+
+/*------------------MODULE LOCAL DEFINITIONS-------------------*/
+namespace {
+  bool CanCoalesce(LiveRange* lrsrc, LiveRange* lrdst, Block* blk,
+                   Unsigned_Int copy_op);
+  bool LastReferenceIn(LiveRange* lr, Block* blk, Unsigned_Int op);
+  bool SharesOnlyBlock(LiveRange* lr1, LiveRange* lr2, Block* blk);
+  bool BriggsTest(LiveRange* lr1, LiveRange* lr2);
+  bool GeorgeTest(LiveRange* lr1, LiveRange* lr2);
+  inline int Degree(LiveRange* lr) { return lr->fear_list->size(); }
+  inline int Colors(LiveRange* lr)
+  {
+    return RegisterClass::NumMachineReg(lr->rc) / lr->RegWidth();
+  }
+}
+
+/*--------------------BEGIN IMPLEMENTATION---------------------*/
+/*
+ *===========================
+ * Coalesce::CoalesceCopies()
+ *===========================
+ * Walks the copies in the program and unions the live ranges of the
+ * source and destination when they pass the coalescing tests. Each
+ * live range takes part in at most one coalesce per call since the
+ * interference graph is not updated until the live ranges are
+ * rebuilt. Returns the number of live ranges that were merged away,
+ * the caller should rebuild the live ranges and call again until this
+ * returns zero.
+ ***/
+unsigned int Coalesce::CoalesceCopies()
+{
+  using Chow::live_ranges;
+  using Mapping::SSAName2OrigLRID;
+
+  std::vector<bool> touched(live_ranges.size(), false);
+  unsigned int merged = 0;
+  Block* blk;
+  Inst* inst;
+  Operation** op;
+  ForAllBlocks(blk)
+  {
+    //index of the operation in the block, as in the operand table
+    Unsigned_Int op_idx = 0;
+    Block_ForAllInsts(inst, blk)
+    {
+      Inst_ForAllOperations(op, inst)
+      {
+        Unsigned_Int copy_op = op_idx++;
+        if(!(opcode_specs[(*op)->opcode].details & COPY)) continue;
+
+        Variable src = (*op)->arguments[0];
+        Variable dst = (*op)->arguments[1];
+        if(src == 0 || dst == 0) continue;
+
+        LiveRange* lrsrc = live_ranges[SSAName2OrigLRID(src)];
+        LiveRange* lrdst = live_ranges[SSAName2OrigLRID(dst)];
+        if(lrsrc == lrdst) continue;
+        if(touched[lrsrc->id] || touched[lrdst->id]) continue;
+        if(Params::Algorithm::rematerialize && 
+           Remat::tags[src].val != Remat::tags[dst].val) continue;
+        if(!CanCoalesce(lrsrc, lrdst, blk, copy_op)) continue;
+
+        debug("coalescing copy r%d => r%d (lrs %d, %d) in %s",
+              src, dst, lrsrc->id, lrdst->id, bname(blk));
+        UFSet_Union(uf_sets, src, dst);
+        if(Params::Algorithm::rematerialize)
+        {
+          UFSet_Union(Remat::remat_sets, src, dst);
+        }
+        touched[lrsrc->id] = touched[lrdst->id] = true;
+        merged++;
+      }
+    }
+  }
+
+  return merged;
+}
+
+/*-------------------BEGIN LOCAL DEFINITIONS-------------------*/
+namespace {
+/*
+ *===================
+ * CanCoalesce()
+ *===================
+ * Checks that a copy from lrsrc to lrdst in blk can be removed by
+ * putting the two live ranges together.
+ *
+ * The chow interference graph is built at block granularity so the
+ * two live ranges of a copy always interfere in the copy's block. We
+ * allow the coalesce when that block is the only one they share, the
+ * destination begins with the copy and the copy is the last reference
+ * to the source in that block. In that case the two values are never
+ * live at the same time with different values.
+ *
+ * The rest of the block is safe because it only sees the destination.
+ * The merged live range must keep one definition per block, since the
+ * orig_name of a live unit is the name of its last definition and the
+ * stores are placed by that name. A later use of the source would make
+ * it the name seen last when the block is walked in reverse, and the
+ * copy's definition of the destination would then be a second name
+ * for the same unit.
+ ***/
+bool CanCoalesce(LiveRange* lrsrc, LiveRange* lrdst, Block* blk,
+                 Unsigned_Int copy_op)
+{
+  //the frame pointer lives in a reserved register (see Spill::Init)
+  if(lrsrc->id == 0 || lrdst->id == 0) return false;
+  if(lrsrc->is_local || lrdst->is_local) return false;
+  if(lrsrc->rc != lrdst->rc) return false;
+  if(lrsrc->RegWidth() != lrdst->RegWidth()) return false;
+
+  LiveUnit* srcunit = lrsrc->LiveUnitForBlock(blk);
+  LiveUnit* dstunit = lrdst->LiveUnitForBlock(blk);
+  if(srcunit == NULL || dstunit == NULL) return false;
+  if(srcunit->defs > 0 || !dstunit->start_with_def) return false;
+  if(!LastReferenceIn(lrsrc, blk, copy_op)) return false;
+  if(!SharesOnlyBlock(lrsrc, lrdst, blk)) return false;
+
+  return BriggsTest(lrsrc, lrdst) || GeorgeTest(lrsrc, lrdst);
+}
+
+/* true if no operation after +op+ in the block uses or defines the
+ * live range */
+bool LastReferenceIn(LiveRange* lr, Block* blk, Unsigned_Int op)
+{
+  using Operands::Operand;
+  for(const Operand* o = Operands::Begin(blk); o != Operands::End(blk); o++)
+  {
+    if(o->op > op && o->kind != Operands::CALL_OPERAND && o->lrid == lr->id)
+      return false;
+  }
+  return true;
+}
+
+bool SharesOnlyBlock(LiveRange* lr1, LiveRange* lr2, Block* blk)
+{
+  if(lr1->units->size() > lr2->units->size()) std::swap(lr1, lr2);
+  for(LiveRange::iterator it = lr1->begin(); it != lr1->end(); it++)
+  {
+    Block* b = (*it)->block;
+    if(b != blk && lr2->ContainsBlock(b)) return false;
+  }
+  return true;
+}
+
+/*
+ *===================
+ * BriggsTest()
+ *===================
+ * the merged live range has fewer than k neighbors of significant
+ * degree
+ ***/
+bool BriggsTest(LiveRange* lr1, LiveRange* lr2)
+{
+  typedef LazySet::iterator SI;
+  int k = Colors(lr1);
+  int significant = 0;
+  for(SI si = lr1->fear_list->begin(); si != lr1->fear_list->end(); si++)
+  {
+    if(*si != lr2 && Degree(*si) >= Colors(*si)) significant++;
+  }
+  for(SI si = lr2->fear_list->begin(); si != lr2->fear_list->end(); si++)
+  {
+    if(*si != lr1 && !lr1->fear_list->member(*si) && 
+       Degree(*si) >= Colors(*si)) significant++;
+  }
+  return significant < k;
+}
+
+/*
+ *===================
+ * GeorgeTest()
+ *===================
+ * every neighbor of lr1 either already interferes with lr2 or is of
+ * insignificant degree
+ ***/
+bool GeorgeTest(LiveRange* lr1, LiveRange* lr2)
+{
+  typedef LazySet::iterator SI;
+  for(SI si = lr1->fear_list->begin(); si != lr1->fear_list->end(); si++)
+  {
+    LiveRange* neb = *si;
+    if(neb == lr2) continue;
+    if(!lr2->fear_list->member(neb) && Degree(neb) >= Colors(neb))
+      return false;
+  }
+  return true;
+}
+}
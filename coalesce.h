@@ -0,0 +1,17 @@
+/* contains functions for conservative coalescing of copy related live
+ * ranges before allocation begins.
+ */
+
+#ifndef __GUARD_COALESCE_H
+#define __GUARD_COALESCE_H
+
+#include <Shared.h>
+#include "types.h"
+#include "debug.h"
+
+namespace Coalesce {
+  unsigned int CoalesceCopies();
+}
+
+#endif
+
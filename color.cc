@@ -7,6 +7,7 @@
 /*-----------------------MODULE INCLUDES-----------------------*/
 #include <utility>
 #include <map>
+#include <algorithm>
 
 #include "color.h"
 #include "chow.h"
@@ -15,10 +16,24 @@
 #include "assign.h"
 #include "params.h"
 #include "heuristics.h"
+#include "lazy_set.h"
 
 /*------------------MODULE LOCAL DEFINITIONS-------------------*/
 namespace {
+  using Coloring::ColorMask;
+  using Coloring::ColorWord;
+  using Coloring::COLOR_WORD_BITS;
+  using Coloring::COLOR_MASK_WORDS;
+
   VectorSet** mRcBlkId_VsUsedColor;
+  ColorMask** mRcBlkId_MaskUsedColor;
+
+  /* number of mask words the kernels run on. zero means some register
+   * class is too large for a ColorMask and we use the VectorSets */
+  unsigned int mask_words = 0;
+
+  /* colors that may start a register of width 1 or 2 */
+  const ColorWord STRIDE_MASK[] = {0, ~0ull, 0x5555555555555555ull};
 
   //mapping from block * register class * color --> lrid
   //this is maintained for the assingnment module which needs this
@@ -46,6 +61,137 @@ namespace {
   {
     return RegisterClass::NumMachineReg(lr->rc) - step + 1;
   }
+
+  void PreferCallSavedColors(const LiveRange*, std::vector<Color>&);
+
+  inline bool UseKernel(int step)
+  {
+    return mask_words > 0 && step < 3;
+  }
+
+  inline void MaskInsert(ColorMask& mask, Color color, int width)
+  {
+    for(int i = 0; i < width; i++)
+    {
+      Color c = color + i;
+      mask.w[c / COLOR_WORD_BITS] |= (1ull << (c % COLOR_WORD_BITS));
+    }
+  }
+
+  inline void MaskUnion(ColorMask& dst, const ColorMask& src)
+  {
+    for(unsigned int i = 0; i < COLOR_MASK_WORDS; i++) dst.w[i] |= src.w[i];
+  }
+
+  /* the forbidden set of a live range is the union of the colors used
+   * in its blocks. forbidden_count[c] is how many of those blocks use
+   * c, so a color only enters or leaves the set when its count moves
+   * between zero and one */
+  inline void CountColor(LiveRange* lr, Color c)
+  {
+    if(lr->forbidden_count[c]++ > 0) return;
+    lr->forbidden_size++;
+    VectorSet_Insert(lr->forbidden, c);
+    if(mask_words)
+      lr->forbidden_mask().w[c / COLOR_WORD_BITS] |= 
+        (1ull << (c % COLOR_WORD_BITS));
+  }
+
+  inline void UncountColor(LiveRange* lr, Color c)
+  {
+    assert(lr->forbidden_count[c] > 0);
+    if(--lr->forbidden_count[c] > 0) return;
+    lr->forbidden_size--;
+    VectorSet_Delete(lr->forbidden, c);
+    if(mask_words)
+      lr->forbidden_mask().w[c / COLOR_WORD_BITS] &= 
+        ~(1ull << (c % COLOR_WORD_BITS));
+  }
+
+  /* calls +count+ for each color used in the block */
+  void ForEachUsedColor(LiveRange* lr, Block* blk, 
+                        void (*count)(LiveRange*, Color))
+  {
+    if(mask_words)
+    {
+      const ColorMask& used = mRcBlkId_MaskUsedColor[lr->rc][bid(blk)];
+      for(unsigned int i = 0; i < mask_words; i++)
+      {
+        for(ColorWord w = used.w[i]; w != 0; w &= w - 1)
+          count(lr, i * COLOR_WORD_BITS + __builtin_ctzll(w));
+      }
+      return;
+    }
+
+    VectorSet used = mRcBlkId_VsUsedColor[lr->rc][bid(blk)];
+    Unsigned_Int cReg = RegisterClass::NumMachineReg(lr->rc);
+    for(Color c = 0; c < cReg; c++)
+      if(VectorSet_Member(used, c)) count(lr, c);
+  }
+
+  /* computes in +starts+ the colors that could hold a register of
+   * width +step+ given the +used+ colors: c is set when c is a
+   * multiple of step, c < ub, and c..c+step-1 are all free. NW is the
+   * number of words in use so the loops unroll for each register
+   * file size */
+  template<unsigned int NW>
+  inline void FreeStarts(const ColorMask& used, unsigned int ub, int step,
+                         ColorWord* starts)
+  {
+    for(unsigned int i = 0; i < NW; i++)
+    {
+      ColorWord free = ~used.w[i];
+      if(step == 2)
+      {
+        //the second half of a pair may live in the next word
+        ColorWord next = (i + 1 < NW) ? ~used.w[i+1] : 0;
+        free &= (free >> 1) | (next << (COLOR_WORD_BITS - 1));
+      }
+      free &= STRIDE_MASK[step];
+
+      unsigned int base = i * COLOR_WORD_BITS;
+      if(ub <= base) free = 0;
+      else if(ub - base < COLOR_WORD_BITS) free &= (1ull << (ub - base)) - 1;
+      starts[i] = free;
+    }
+  }
+
+  template<unsigned int NW>
+  inline int CountStarts(const ColorMask& used, unsigned int ub, int step)
+  {
+    ColorWord starts[NW];
+    FreeStarts<NW>(used, ub, step, starts);
+    int count = 0;
+    for(unsigned int i = 0; i < NW; i++) 
+      count += __builtin_popcountll(starts[i]);
+    return count;
+  }
+
+  template<unsigned int NW>
+  inline void ListStarts(const ColorMask& used, unsigned int ub, int step,
+                         std::vector<Color>& choices)
+  {
+    ColorWord starts[NW];
+    FreeStarts<NW>(used, ub, step, starts);
+    for(unsigned int i = 0; i < NW; i++)
+    {
+      for(ColorWord bits = starts[i]; bits; bits &= bits - 1)
+        choices.push_back(i * COLOR_WORD_BITS + __builtin_ctzll(bits));
+    }
+  }
+
+  inline int KernelCount(const ColorMask& used, unsigned int ub, int step)
+  {
+    return mask_words == 1 ? CountStarts<1>(used, ub, step)
+                           : CountStarts<2>(used, ub, step);
+  }
+
+  inline void KernelList(const ColorMask& used, unsigned int ub, int step,
+                         std::vector<Color>& choices)
+  {
+    if(mask_words == 1) ListStarts<1>(used, ub, step, choices);
+    else                ListStarts<2>(used, ub, step, choices);
+  }
 }
 
 /*--------------------BEGIN IMPLEMENTATION---------------------*/
@@ -56,12 +202,30 @@ void Coloring::Init(Arena arena, unsigned int num_live_ranges)
   int num_reg_classes = RegisterClass::all_classes.size();
   mRcBlkId_VsUsedColor = (VectorSet**)
        Arena_GetMemClear(arena,sizeof(VectorSet*)*(num_reg_classes));
+  mRcBlkId_MaskUsedColor = (ColorMask**)
+       Arena_GetMemClear(arena,sizeof(ColorMask*)*(num_reg_classes));
+
+  //pick the kernel width from the largest register class. the usual
+  //8, 16, 32 and 64 register machines all fit in one word
+  int cRegMax = 0;
+  for(unsigned int i = 0; i < RegisterClass::all_classes.size(); i++)
+  {
+    RegisterClass::RC rc = RegisterClass::all_classes[i];
+    cRegMax = std::max(cRegMax, RegisterClass::NumMachineReg(rc));
+  }
+  if(cRegMax <= (int)COLOR_WORD_BITS) mask_words = 1;
+  else if(cRegMax <= (int)(COLOR_WORD_BITS*COLOR_MASK_WORDS)) mask_words = 2;
+  else mask_words = 0;
+  debug("coloring kernel uses %d words for %d registers (-r %d)",
+        mask_words, cRegMax, Params::Machine::num_registers);
 
   for(unsigned int i = 0; i < RegisterClass::all_classes.size(); i++)
   {
     RegisterClass::RC rc = RegisterClass::all_classes[i];
     mRcBlkId_VsUsedColor[rc] = (VectorSet*)
         Arena_GetMemClear(arena,sizeof(VectorSet)*(block_count+1));
+    mRcBlkId_MaskUsedColor[rc] = (ColorMask*)
+        Arena_GetMemClear(arena,sizeof(ColorMask)*(block_count+1));
     Block* b;
     ForAllBlocks(b)
     {
@@ -84,11 +248,129 @@ void Coloring::SetColor(Block* blk, LRID lrid, Color color)
   inverse_color_map[std::make_pair(blk,lr->rc)][color] = lrid;
 }
 
+/*
+ *============================
+ * Coloring::UseColor()
+ *============================
+ * marks +width+ colors starting at +color+ as taken in the block
+ ***/
+void Coloring::UseColor(RegisterClass::RC rc, Block* blk, Color color, 
+                        int width)
+{
+  VectorSet vs = UsedColors(rc, blk);
+  for(int i = 0; i < width; i++) VectorSet_Insert(vs, color+i);
+  if(mask_words) MaskInsert(mRcBlkId_MaskUsedColor[rc][bid(blk)], 
+                            color, width);
+}
+
+/*
+ *============================
+ * Coloring::ForbidColor()
+ *============================
+ * counts +width+ colors starting at +color+ as used in one more block
+ * of the live range, adding them to the forbidden set
+ ***/
+void Coloring::ForbidColor(LiveRange* lr, Color color, int width)
+{
+  for(int i = 0; i < width; i++) CountColor(lr, color+i);
+}
+
+/*
+ *============================
+ * Coloring::ForbidUsedColors()
+ *============================
+ * adds the colors used in the block to the forbidden set. called when
+ * the block joins the live range
+ ***/
+void Coloring::ForbidUsedColors(LiveRange* lr, Block* blk)
+{
+  ForEachUsedColor(lr, blk, CountColor);
+}
+
+/*
+ *============================
+ * Coloring::AllowUsedColors()
+ *============================
+ * undoes ForbidUsedColors() when the block leaves the live range.
+ * colors still used in some other block of the live range stay
+ * forbidden
+ ***/
+void Coloring::AllowUsedColors(LiveRange* lr, Block* blk)
+{
+  ForEachUsedColor(lr, blk, UncountColor);
+}
+
+void Coloring::ClearForbidden(LiveRange* lr)
+{
+  VectorSet_Clear(lr->forbidden);
+  ColorMask empty = {{0}};
+  lr->forbidden_mask() = empty;
+  std::fill(lr->forbidden_count, 
+            lr->forbidden_count + RegisterClass::NumMachineReg(lr->rc), 0u);
+  lr->forbidden_size = 0;
+}
+
+/*
+ *=================================
+ * Coloring::NeighborForbiddenCounts()
+ *=================================
+ * sets counts[c] to the number of the live range's neighbors that
+ * have color c forbidden. the neighbors' forbidden masks are summed
+ * into bit slices, slice k holding bit k of every color's count, so
+ * each neighbor costs a few word operations rather than a probe per
+ * color
+ ***/
+void Coloring::NeighborForbiddenCounts(const LiveRange* lr, 
+                                       std::vector<int>& counts)
+{
+  typedef LazySet::iterator SI;
+  Unsigned_Int cReg = RegisterClass::NumMachineReg(lr->rc);
+  counts.assign(cReg, 0);
+
+  if(!mask_words)
+  {
+    for(SI si = lr->fear_list->begin(); si != lr->fear_list->end(); si++)
+      for(Color c = 0; c < cReg; c++)
+        if(VectorSet_Member((*si)->forbidden, c)) counts[c]++;
+    return;
+  }
+
+  ColorMask empty = {{0}};
+  std::vector<ColorMask> slices;
+  for(SI si = lr->fear_list->begin(); si != lr->fear_list->end(); si++)
+  {
+    //ripple carry add of the neighbor's mask into the slices
+    ColorMask x = (*si)->forbidden_mask();
+    for(unsigned int k = 0; ; k++)
+    {
+      ColorWord any = 0;
+      for(unsigned int i = 0; i < mask_words; i++) any |= x.w[i];
+      if(!any) break;
+      if(k == slices.size()) slices.push_back(empty);
+      for(unsigned int i = 0; i < mask_words; i++)
+      {
+        ColorWord carry = slices[k].w[i] & x.w[i];
+        slices[k].w[i] ^= x.w[i];
+        x.w[i] = carry;
+      }
+    }
+  }
+
+  for(unsigned int k = 0; k < slices.size(); k++)
+  {
+    for(unsigned int i = 0; i < mask_words; i++)
+    {
+      for(ColorWord w = slices[k].w[i]; w != 0; w &= w - 1)
+        counts[i * COLOR_WORD_BITS + __builtin_ctzll(w)] += (1 << k);
+    }
+  }
+}
+
 Color Coloring::GetColor(Block* blk, LRID lrid)
 {
   LiveRange* lr = (*Chow::live_ranges[lrid]->blockmap)[(bid(blk))];
   assert(lr); /* could also return NO_COLOR if lr is NULL */
-  return lr->color;
+  return lr->color();
 }
 
 LRID Coloring::GetLRID(Block* blk, RegisterClass::RC rc, Color color)
@@ -99,6 +381,11 @@ LRID Coloring::GetLRID(Block* blk, RegisterClass::RC rc, Color color)
   return lrid;
 }
 
+bool Coloring::IsColorAvailable(const LiveRange* lr)
+{
+  return (NumColorsAvailable(lr) > 0);
+}
+
 bool Coloring::IsColorAvailable(const LiveRange* lr, Block* blk)
 {
   return IsColorAvailable(lr, UsedColors(lr->rc, blk));
@@ -111,9 +398,35 @@ bool Coloring::IsColorAvailable(const LiveRange* lr, VectorSet used_colors)
 
 int Coloring::NumColorsAvailable(const LiveRange* lr)
 {
+  int step = RegisterClass::RegWidth(lr->type);
+  if(UseKernel(step))
+    return KernelCount(lr->forbidden_mask(), UB(lr, step), step);
+
   return NumColorsAvailable(lr, lr->forbidden);
 }
 
+/*
+ *==========================================
+ * Coloring::NumColorsAvailableAfterBlock()
+ *==========================================
+ * number of colors left for the live range if it were to also
+ * include the given block
+ ***/
+int Coloring::NumColorsAvailableAfterBlock(const LiveRange* lr, Block* blk)
+{
+  int step = RegisterClass::RegWidth(lr->type);
+  if(UseKernel(step))
+  {
+    ColorMask used = lr->forbidden_mask();
+    MaskUnion(used, mRcBlkId_MaskUsedColor[lr->rc][bid(blk)]);
+    return KernelCount(used, UB(lr, step), step);
+  }
+
+  VectorSet used_colors = RegisterClass::TmpVectorSet(lr->rc);
+  VectorSet_Union(used_colors, lr->forbidden, UsedColors(lr->rc, blk));
+  return NumColorsAvailable(lr, used_colors);
+}
+
 int Coloring::NumColorsAvailable(const LiveRange* lr, VectorSet used_colors)
 {
   int num_avail = 0;
@@ -134,15 +447,74 @@ Color Coloring::SelectColor(const LiveRange* lr)
   std::vector<Color> choices;
   int step = RegisterClass::RegWidth(lr->type);
   unsigned int ub = UB(lr, step);
-  for(Color c = 0; c < ub; c+=step)
+  if(UseKernel(step))
   {
-    if(HasSpace(lr->forbidden, c, step)) choices.push_back(c);
+    KernelList(lr->forbidden_mask(), ub, step, choices);
+  }
+  else
+  {
+    for(Color c = 0; c < ub; c+=step)
+    {
+      if(HasSpace(lr->forbidden, c, step)) choices.push_back(c);
+    }
   }
 
   assert(!choices.empty());/*should always find a color */
-  return (*Chow::Heuristics::color_choice_strategy)(lr, choices);
+  if(RegisterClass::NumCalleeSaved(lr->rc) > 0)
+    PreferCallSavedColors(lr, choices);
+  return Chow::Heuristics::ChooseColor(lr, choices);
+}
+
+/*
+ *=========================================
+ * Coloring::IsCalleeSavedColorAvailable()
+ *=========================================
+ * true if the live range could still be given a callee saved register
+ ***/
+bool Coloring::IsCalleeSavedColorAvailable(const LiveRange* lr)
+{
+  int step = RegisterClass::RegWidth(lr->type);
+  unsigned int ub = UB(lr, step);
+  for(Color c = 0; c < ub; c+=step)
+  {
+    if(RegisterClass::IsCalleeSaved(lr->rc, c) && 
+       HasSpace(lr->forbidden, c, step)) return true;
+  }
+  return false;
 }
 
 /*------------------INTERNAL MODULE FUNCTIONS--------------------*/
+namespace {
+/*
+ *============================
+ * PreferCallSavedColors()
+ *============================
+ * narrows the color choices so that live ranges that cross calls get
+ * a callee saved register when one is free, and the rest stay out of
+ * the callee saved registers when they can
+ ***/
+void PreferCallSavedColors(const LiveRange* lr, std::vector<Color>& choices)
+{
+  typedef std::vector<Color>::const_iterator CI;
+  std::vector<Color> callee_saved;
+  std::vector<Color> caller_saved;
+  for(CI ci = choices.begin(); ci != choices.end(); ci++)
+  {
+    if(RegisterClass::IsCalleeSaved(lr->rc, *ci)) 
+      callee_saved.push_back(*ci);
+    else
+      caller_saved.push_back(*ci);
+  }
+
+  if(lr->CallWeight() > 0.0)
+  {
+    if(!callee_saved.empty()) choices.swap(callee_saved);
+  }
+  else
+  {
+    if(!caller_saved.empty()) choices.swap(caller_saved);
+  }
+}
+}
 
 
@@ -5,6 +5,7 @@
 #define __GUARD_COLOR_H
 
 #include <Shared.h>
+#include <vector>
 #include "types.h"
 #include "debug.h"
 #include "rc.h"
@@ -16,18 +17,39 @@ namespace Coloring {
   /* constants */
   extern const Color NO_COLOR;
 
+  /* fixed width color set mirrored alongside the forbidden and used
+   * color VectorSets. when every register class fits in two words the
+   * availability checks run on these masks with a kernel specialized
+   * for the word count instead of probing the VectorSet per color */
+  typedef unsigned long long ColorWord;
+  const unsigned int COLOR_WORD_BITS = 64;
+  const unsigned int COLOR_MASK_WORDS = 2;
+  struct ColorMask
+  {
+    ColorWord w[COLOR_MASK_WORDS];
+  };
+
   /* functions */
   void Init(Arena, unsigned int num_live_ranges);
   VectorSet UsedColors(RegisterClass::RC rc, Block* b);
   void SetColor(Block* blk, LRID lrid, Color color);
+  void UseColor(RegisterClass::RC rc, Block* blk, Color color, int width);
+  void ForbidColor(LiveRange* lr, Color color, int width);
+  void ForbidUsedColors(LiveRange* lr, Block* blk);
+  void AllowUsedColors(LiveRange* lr, Block* blk);
+  void ClearForbidden(LiveRange* lr);
+  void NeighborForbiddenCounts(const LiveRange* lr, std::vector<int>& counts);
   Color GetColor(Block* blk, LRID lrid);
   LRID GetLRID(Block* blk, RegisterClass::RC rc, Color color);
 
+  bool IsColorAvailable(const LiveRange* lr);
   bool IsColorAvailable(const LiveRange* lr, Block* blk);
   bool IsColorAvailable(const LiveRange* lr, VectorSet used_colors);
   int  NumColorsAvailable(const LiveRange* lr);
+  int  NumColorsAvailableAfterBlock(const LiveRange* lr, Block* blk);
   int  NumColorsAvailable(const LiveRange* lr, VectorSet used_colors);
   Color SelectColor(const LiveRange* lr);
+  bool IsCalleeSavedColorAvailable(const LiveRange* lr);
 }
 
 
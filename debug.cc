@@ -58,7 +58,7 @@ bool dump_all_splits = false;
  *======================
  *
  ***/
-void LiveRange_DDumpAll(LRVec* lrs)
+void LiveRange_DDumpAll(LiveRangeView* lrs)
 {
 #ifdef __DEBUG
   LiveRange_DumpAll(lrs);
@@ -71,11 +71,11 @@ void LiveRange_DDumpAll(LRVec* lrs)
  *======================
  *
  ***/
-void LiveRange_DumpAll(LRVec* lrs)
+void LiveRange_DumpAll(LiveRangeView* lrs)
 {
-  for(LRVec::iterator i = lrs->begin(); i != lrs->end(); i++)
+  for(LRID i = 0; i < lrs->size(); i++)
   {
-    LiveRange_Dump(*i);
+    LiveRange_Dump((*lrs)[i]);
   }
 }
 
@@ -105,24 +105,25 @@ void LiveRange_Dump(LiveRange* lr)
   fprintf(stderr,"************ BEGIN LIVE RANGE DUMP **************\n");
   fprintf(stderr,"LR: %d\n",lr->id);
   fprintf(stderr,"type: %s\n",type_str[lr->type]);
-  fprintf(stderr,"color: %d\n", lr->color);
+  fprintf(stderr,"color: %d\n", lr->color());
   fprintf(stderr,"orig_lrid: %d\n", lr->orig_lrid);
-  fprintf(stderr,"candidate?: %c\n", lr->is_candidate ? 'T' : 'F');
+  fprintf(stderr,"candidate?: %c\n", lr->is_candidate() ? 'T' : 'F');
   fprintf(stderr,"rematerializable?: %c\n", lr->rematerializable 
                                             ? 'T' : 'F');
   fprintf(stderr,"local?: %c\n", lr->is_local ? 'T' : 'F');
   fprintf(stderr,"num_neighbors: %d\n", lr->fear_list->size());
-  fprintf(stderr,"num_colored_neighbors: %d\n", lr->num_colored_neighbors);
+  fprintf(stderr,"num_colored_neighbors: %d\n", lr->num_colored_neighbors());
   fprintf(stderr,"simplified_neighbor_count: %d\n",
                                   lr->simplified_neighbor_count);
   fprintf(stderr,"simplified_width: %d\n", lr->simplified_width);
   fprintf(stderr,"forbidden colors: \n");
     VectorSet_Dump(lr->forbidden);
   fprintf(stderr, "BB LIST:\n");
-    Unsigned_Int b;
-    VectorSet_ForAll(b, lr->bb_list)
+    std::vector<uint> blocks;
+    lr->bb_list->elements(blocks);
+    for(uint i = 0; i < blocks.size(); i++)
     {
-      fprintf(stderr, "  %d\n", (b));
+      fprintf(stderr, "  %d\n", blocks[i]);
     }
 
   fprintf(stderr, "Live Unit LIST:\n");
@@ -33,13 +33,14 @@
 //forward defs
 struct LiveUnit;
 struct LiveRange;
+struct LiveRangeView;
 namespace Debug {
   extern std::vector<LiveRange*> dot_dumped_lrs;
   extern LRID dot_dump_lr;
   extern bool dump_all_splits;
 
-  void LiveRange_DumpAll(LRVec*);
-  void LiveRange_DDumpAll(LRVec* lrs);
+  void LiveRange_DumpAll(LiveRangeView*);
+  void LiveRange_DDumpAll(LiveRangeView* lrs);
   void LiveRange_Dump(LiveRange* lr);
   void LiveRange_DDump(LiveRange* lr);
   void LiveUnit_Dump(LiveUnit* );
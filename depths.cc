@@ -26,7 +26,10 @@ void find_nesting_depths(Arena external_arena)
 {
     depths = (Unsigned_Int*)
         Arena_GetMemClear(external_arena,
-                          (block_count+1)*sizeof(Unsigned_Int2));
+                          (block_count+1)*sizeof(Unsigned_Int));
+    loop_heads = (Unsigned_Int*)
+        Arena_GetMemClear(external_arena,
+                          (block_count+1)*sizeof(Unsigned_Int));
     depth_arena = Arena_Create();
     {
         Unsigned_Int index = 1;
@@ -88,6 +91,7 @@ void find_nesting_depths(Arena external_arena)
                     {
                         Unsigned_Int block_index = block->preorder_index;
                         Unsigned_Int i;
+                        loop_heads[block_index] = block_index;
                         SparseSet_ForAll(i, loop)
                         {
                             Unsigned_Int depth = ++(depths[i]);
@@ -136,6 +140,18 @@ void find_nesting_depths(Arena external_arena)
         }
     }
     
+    /* a header is its own loop head, all other blocks take the
+     * header of the innermost loop that contains them */
+    {
+        Block *block;
+        ForAllBlocks(block)
+        {
+            Unsigned_Int block_num = block->preorder_index;
+            if (!loop_heads[block_num])
+                loop_heads[block_num] = DJ_graph_info[block_num].loop_head;
+        }
+    }
+
     if (debug)
     {
         Block *block;
@@ -263,6 +279,7 @@ static void dfs(Unsigned_Int i)
         else
         {
             Unsigned_Int scc = 0;
+            loop_heads[i] = i;
             do
             {
                 name = dfs_stack;
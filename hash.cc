@@ -0,0 +1,55 @@
+/* hash.cc
+ *
+ * 64 bit FNV-1a hashing of memory and files.
+ */
+
+/*-----------------------MODULE INCLUDES-----------------------*/
+#include <stdio.h>
+#include "hash.h"
+
+/*--------------------BEGIN IMPLEMENTATION---------------------*/
+namespace Hash {
+
+/*
+ *============================
+ * Hash::Bytes()
+ *============================
+ * folds +n+ bytes into the hash +h+. chain calls to hash several
+ * pieces as if they were one
+ ***/
+Value Bytes(const void* data, size_t n, Value h)
+{
+  const unsigned char* p = static_cast<const unsigned char*>(data);
+  for(size_t i = 0; i < n; i++)
+  {
+    h ^= p[i];
+    h *= 1099511628211ull;
+  }
+  return h;
+}
+
+/*
+ *============================
+ * Hash::File()
+ *============================
+ * folds the contents of the file into +h+. returns false if the file
+ * could not be read
+ ***/
+bool File(const char* fname, Value* h)
+{
+  FILE* fp = fopen(fname, "rb");
+  if(fp == NULL) return false;
+
+  unsigned char buf[64*1024];
+  size_t n;
+  while((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+  {
+    *h = Bytes(buf, n, *h);
+  }
+  bool ok = !ferror(fp);
+  fclose(fp);
+  return ok;
+}
+
+}//end Hash namespace
+
@@ -0,0 +1,19 @@
+/* 64 bit FNV-1a hashing of memory and files, used to key the on disk
+ * caches by their input.
+ */
+
+#ifndef __GUARD_HASH_H
+#define __GUARD_HASH_H
+
+#include <stddef.h>
+
+namespace Hash {
+  typedef unsigned long long Value;
+  const Value INITIAL = 14695981039346656037ull;
+
+  Value Bytes(const void* data, size_t n, Value h = INITIAL);
+  bool File(const char* fname, Value* h);
+}
+
+#endif
+
@@ -11,6 +11,8 @@
 #include "color.h"
 #include "chow.h"
 #include "priority.h"
+#include "shared_globals.h"
+#include "params.h"
 
 /*------------------MODULE LOCAL DECLARATIONS------------------*/
 namespace {
@@ -23,6 +25,7 @@ SplitWhenNoColorAvailable no_color_available;
 SplitWhenNumNeighborsTooGreat num_neighbors_too_great;
 ChowSplit chow_split;
 UpAndDownSplit up_and_down_split;
+LoopSplit loop_split;
 
 //including
 IncludeWhenNotFull when_not_full;
@@ -45,9 +48,12 @@ PriorityGnuSquareNormal priority_gnu_square_normal;
 template<class T>
 inline T max(T a, T b){return a > b ? a : b;}
 
+template<class S>
+void GrowSplitWith(S& strategy, 
+                   LiveRange* newlr, LiveRange* origlr, LiveUnit* start);
 unsigned int ColorsLeftAfterBlock(LiveRange* lr, Block* blk);
 Color FindMaxOrDefault(
-  const std::map<Color,int>& color_count_map,
+  const std::vector<int>& color_count,
   const std::vector<Color>& choices
 );
 }
@@ -62,9 +68,122 @@ WhenToSplitStrategy* when_to_split_strategy = NULL;
 SplitStrategy* how_to_split_strategy = NULL;
 PriorityFunctionStrategy* priority_strategy = NULL;
 
+//the selected strategies are kept only in the algorithm parameters
+using Params::Algorithm::color_choice;
+using Params::Algorithm::include_in_split;
+using Params::Algorithm::when_to_split;
+using Params::Algorithm::how_to_split;
+using Params::Algorithm::priority_function;
+
+/*
+ * STATIC DISPATCH
+ * each call names the concrete strategy type so the call is bound at
+ * compile time and the strategy body can be inlined here
+ */
+Priority ComputePriority(LiveRange* lr)
+{
+  switch(priority_function)
+  {
+    case CLASSIC:
+      return priority_classic.PriorityClassic::operator()(lr);
+    case NO_NORMAL:
+      return priority_no_normal.PriorityNoNormal::operator()(lr);
+    case SQUARE_NORMAL:
+      return priority_square_normal.PrioritySquareNormal::operator()(lr);
+    case GNU:
+      return priority_gnu.PriorityGnu::operator()(lr);
+    case GNU_SQUARE_NORMAL:
+      return priority_gnu_square_normal.
+        PriorityGnuSquareNormal::operator()(lr);
+  }
+  return (*priority_strategy)(lr);
+}
+
+bool ShouldSplit(LiveRange* lr)
+{
+  switch(when_to_split)
+  {
+    case NO_COLOR_AVAILABLE:
+      return no_color_available.SplitWhenNoColorAvailable::operator()(lr);
+    case NUM_NEIGHBORS_TOO_GREAT:
+      return num_neighbors_too_great.
+        SplitWhenNumNeighborsTooGreat::operator()(lr);
+  }
+  return (*when_to_split_strategy)(lr);
+}
+
+void ResetIncludeInSplit(LiveUnit* startunit)
+{
+  switch(include_in_split)
+  {
+    case WHEN_NOT_FULL:
+      return; //nothing to reset
+    case WHEN_ENOUGH_COLORS:
+      when_enough_colors.IncludeWhenEnoughColors::Reset(startunit);
+      return;
+    case WHEN_NOT_TOO_MANY_NEIGHBORS:
+      when_not_too_many_neighbors.
+        IncludeWhenNotTooManyNeighbors::Reset(startunit);
+      return;
+  }
+  include_in_split_strategy->Reset(startunit);
+}
+
+bool IncludeBlockInSplit(LiveRange* lrnew, LiveRange* lrorig, Block* blk)
+{
+  switch(include_in_split)
+  {
+    case WHEN_NOT_FULL:
+      return when_not_full.
+        IncludeWhenNotFull::operator()(lrnew, lrorig, blk);
+    case WHEN_ENOUGH_COLORS:
+      return when_enough_colors.
+        IncludeWhenEnoughColors::operator()(lrnew, lrorig, blk);
+    case WHEN_NOT_TOO_MANY_NEIGHBORS:
+      return when_not_too_many_neighbors.
+        IncludeWhenNotTooManyNeighbors::operator()(lrnew, lrorig, blk);
+  }
+  return (*include_in_split_strategy)(lrnew, lrorig, blk);
+}
+
+Color ChooseColor(const LiveRange* lr, const std::vector<Color>& choices)
+{
+  switch(color_choice)
+  {
+    case CHOOSE_FIRST_COLOR:
+      return choose_first_color.
+        ChooseFirstColor::operator()(lr, choices);
+    case CHOOSE_FROM_MOST_CONSTRAINED:
+      return choose_from_most_constrained.
+        ChooseColorFromMostConstrainedNeighbor::operator()(lr, choices);
+    case CHOOSE_FROM_MOST_FORBIDDEN:
+      return choose_most_forbidden.
+        ChooseColorInMostNeighborsForbidden::operator()(lr, choices);
+    case CHOOSE_FROM_SPLIT:
+      return choose_from_split.
+        ChooseColorFromSplit::operator()(lr, choices);
+  }
+  return (*color_choice_strategy)(lr, choices);
+}
+
+void GrowSplit(LiveRange* newlr, LiveRange* origlr, LiveUnit* startunit)
+{
+  switch(how_to_split)
+  {
+    case CHOW_SPLIT:
+      GrowSplitWith(chow_split, newlr, origlr, startunit); return;
+    case UP_AND_DOWN_SPLIT:
+      GrowSplitWith(up_and_down_split, newlr, origlr, startunit); return;
+    case LOOP_SPLIT:
+      GrowSplitWith(loop_split, newlr, origlr, startunit); return;
+  }
+  (*how_to_split_strategy)(newlr, origlr, startunit);
+}
+
 //heuristic setters
 void SetColorChoiceStrategy(ColorChoice cs)
 {
+  color_choice = cs;
   switch(cs)
   {
     case CHOOSE_FIRST_COLOR:
@@ -87,6 +206,7 @@ void SetColorChoiceStrategy(ColorChoice cs)
 
 void SetIncludeInSplitStrategy(IncludeInSplit is)
 {
+  include_in_split = is;
   switch(is)
   {
     case WHEN_NOT_FULL:
@@ -106,6 +226,7 @@ void SetIncludeInSplitStrategy(IncludeInSplit is)
 
 void SetWhenToSplitStrategy(WhenToSplit ws)
 {
+  when_to_split = ws;
   switch(ws)
   {
     case NO_COLOR_AVAILABLE:
@@ -122,6 +243,7 @@ void SetWhenToSplitStrategy(WhenToSplit ws)
 
 void SetHowToSplitStrategy(HowToSplit hs)
 {
+  how_to_split = hs;
   switch(hs)
   {
     case CHOW_SPLIT:
@@ -130,6 +252,9 @@ void SetHowToSplitStrategy(HowToSplit hs)
     case UP_AND_DOWN_SPLIT:
       how_to_split_strategy = &up_and_down_split;
       break;
+    case LOOP_SPLIT:
+      how_to_split_strategy = &loop_split;
+      break;
     default:
       error("unknown how to split strategy: %d", hs);
       abort();
@@ -138,6 +263,7 @@ void SetHowToSplitStrategy(HowToSplit hs)
 
 void SetPriorityFunctionStrategy(PriorityFunction pf)
 {
+  priority_function = pf;
   switch(pf)
   {
     case CLASSIC:
@@ -173,7 +299,7 @@ bool SplitWhenNoColorAvailable::operator()(LiveRange* lr)
 bool SplitWhenNumNeighborsTooGreat::operator()(LiveRange* lr)
 {
   double uncolored_neighbors = 
-    lr->fear_list->size() - lr->num_colored_neighbors;
+    lr->fear_list->size() - lr->num_colored_neighbors();
   double num_colors = Coloring::NumColorsAvailable(lr);
   char str[64]; LRName(lr, str);
   debug("(%s) uncolored: %.2f, avail: %.2f, ratio: %.2f max: %.2f", str,
@@ -214,7 +340,7 @@ struct AddIfBlockEq : public std::unary_function<LiveRange*, void>
     : blk(_blk), lrset(_lrset){};
   void operator()(LiveRange* lr)
   {
-    if(lr->ContainsBlock(blk) && lr->color == Coloring::NO_COLOR) 
+    if(lr->ContainsBlock(blk) && lr->color() == Coloring::NO_COLOR) 
       lrset.insert(lr);
   }
 };
@@ -300,46 +426,36 @@ ChooseColorFromMostConstrainedNeighbor::operator()(
 {
   using Coloring::NO_COLOR;
   typedef LazySet::iterator SI;
-  typedef std::vector<LiveRange*>::iterator LI;
   typedef std::vector<Color>::const_iterator CI;
 
   //look at all the live ranges that the live range interferes with
-  //and see which ones have a forbidden color the same as one of the
-  //choices for the given live range
-  std::vector<LiveRange*> lr_choices;
+  //and keep the one with the most forbidden colors among those that
+  //have a forbidden color the same as one of the choices for the given
+  //live range
+  int max_forbidden = -1;
+  LiveRange* max_lr = NULL;
   for(SI si = lr->fear_list->begin(); si != lr->fear_list->end(); si++)
   {
+    int size = (*si)->forbidden_size;
+    if(size <= max_forbidden) continue;
     for(CI ci = choices.begin(); ci != choices.end(); ci++)
     {
       if(VectorSet_Member((*si)->forbidden, *ci))
       {
-        lr_choices.push_back(*si);
+        max_forbidden = size;
+        max_lr = (*si);
         break;
       }
     }
   }
   //if none of the colors to pick from is already in the forbidden
   //list of another live range then just pick the first available
-  if(lr_choices.empty())
+  if(max_lr == NULL)
   {
     debug("no neighbors with forbidden colors, picking any");
     return choices.front();
   }
 
-  //otherwise find the live range that has the most forbidden colors
-  int max_forbidden = -1;
-  LiveRange* max_lr = NULL;
-  for(LI li = lr_choices.begin(); li != lr_choices.end(); li++)
-  {
-    int size = VectorSet_Size((*li)->forbidden);
-    if(size > max_forbidden)
-    {
-      max_forbidden = size;
-      max_lr = (*li);
-    }
-  }
-  assert(max_lr != NULL);
-
   //now choose the color that is available as a choice for this live
   //range and also in the forbidden set of the live range with the
   //most forbidden colors
@@ -364,22 +480,10 @@ ChooseColorInMostNeighborsForbidden::operator()(
   const std::vector<Color>& choices
 )
 {
-  typedef LazySet::iterator SI;
-  typedef std::vector<Color>::const_iterator CI;
-  typedef std::map<Color,int>::const_iterator CCI;
-
-  std::map<Color, int> color_count_map;
-  for(CI ci = choices.begin(); ci != choices.end(); ci++)
-  {
-    for(SI si = lr->fear_list->begin(); si != lr->fear_list->end(); si++)
-    {
-      if(VectorSet_Member((*si)->forbidden, *ci))
-      {
-        color_count_map[*ci]++;
-      }
-    }
-  }
-  return FindMaxOrDefault(color_count_map, choices);
+  //histogram over all colors at once, then read off the choices
+  std::vector<int> color_count;
+  Coloring::NeighborForbiddenCounts(lr, color_count);
+  return FindMaxOrDefault(color_count, choices);
 }
 
 Color 
@@ -388,21 +492,16 @@ ChooseColorFromSplit::operator()(
   const std::vector<Color>& choices
 )
 {
-  typedef std::vector<Color>::const_iterator CI;
-  typedef std::vector<LiveRange*>::const_iterator LI;
+  typedef SplitVec::const_iterator LI;
 
-  std::map<Color, int> color_count_map;
-  for(CI ci = choices.begin(); ci != choices.end(); ci++)
+  //one pass over the splits counts every color
+  std::vector<int> color_count(RegisterClass::NumMachineReg(lr->rc), 0);
+  for(LI li = lr->splits->begin(); li != lr->splits->end(); li++)
   {
-    for(LI li = lr->splits->begin(); li != lr->splits->end(); li++)
-    {
-      if((*li)->color == *ci) color_count_map[*ci]++;
-    }
+    Color color = (*li)->color();
+    if(color < color_count.size()) color_count[color]++;
   }
-
-  //find max
-  typedef std::map<Color,int>::const_iterator CCI;
-  return FindMaxOrDefault(color_count_map, choices);
+  return FindMaxOrDefault(color_count, choices);
 
 }
 
@@ -419,7 +518,7 @@ SplitStrategy::operator()(
   //set instance variables used in splitting functions
   newlr = _newlr;
   origlr = _origlr;
-  include_in_split_strategy->Reset(startunit);
+  ResetIncludeInSplit(startunit);
 
   //keep a queue of successors that we may add to the new live range
   std::list<Block*> fringe_list;
@@ -469,7 +568,7 @@ SplitStrategy::ExpandPreds(Block* blk, FringeList& fringe)
 bool 
 SplitStrategy::IncludeInSplit(Block* blk)
 {
-  return (*include_in_split_strategy)(newlr,origlr,blk);
+  return IncludeBlockInSplit(newlr,origlr,blk);
 }
 
 Block* 
@@ -506,6 +605,77 @@ UpAndDownSplit::ExpandFringeNode(Block* blk, FringeList& fringe)
   ExpandPreds(blk, fringe);
 }
 
+/* 2 */
+/*
+ * grows the split one loop at a time. blocks in deeper loops are
+ * expanded first and edges that leave a loop are only followed once
+ * the loop itself has been claimed, so when the split runs out of
+ * colors the boundary (and the spill code) falls on loop entry and
+ * exit edges rather than inside the loop body.
+ */
+Block* 
+LoopSplit::RemoveFringeNode(FringeList& fringe)
+{
+  using Globals::depths;
+  FringeList::iterator deepest = fringe.begin();
+  for(FringeList::iterator it = fringe.begin(); it != fringe.end(); it++)
+  {
+    if(depths[bid(*it)] > depths[bid(*deepest)]) deepest = it;
+  }
+  Block* blk = *deepest; fringe.erase(deepest);
+  return blk;
+}
+
+void 
+LoopSplit::ExpandFringeNode(Block* blk, FringeList& fringe)
+{
+  Edge* e;
+  Block_ForAllSuccs(e, blk) ExpandInLoop(blk, e->succ, fringe);
+  Block_ForAllPreds(e, blk) ExpandInLoop(blk, e->pred, fringe);
+
+  //once the current loop is exhausted cross the exit edges of the
+  //deepest loop seen so far
+  while(fringe.empty() && !exits.empty())
+  {
+    Block* exit = LoopSplit::RemoveFringeNode(exits);
+    ExpandSuccs(exit, fringe);
+    ExpandPreds(exit, fringe);
+  }
+}
+
+void
+LoopSplit::ExpandInLoop(Block* blk, Block* next, FringeList& fringe)
+{
+  if(!origlr->ContainsBlock(next)) return;
+
+  if(InSameOrDeeperLoop(blk, next))
+  {
+    if(IncludeInSplit(next))
+    {
+      LiveUnit* unit = origlr->LiveUnitForBlock(next);
+      debug("adding block: %s to  lr'", bname(next));
+      origlr->TransferLiveUnitTo(newlr, unit);
+      fringe.push_back(next);
+    }
+  }
+  else if(std::find(exits.begin(), exits.end(), blk) == exits.end())
+  {
+    debug("deferring loop exit from block: %s", bname(blk));
+    exits.push_back(blk);
+  }
+}
+
+bool
+LoopSplit::InSameOrDeeperLoop(Block* from, Block* to)
+{
+  using Globals::depths;
+  using Globals::loop_heads;
+  unsigned int dfrom = depths[bid(from)];
+  unsigned int dto = depths[bid(to)];
+  return (dto > dfrom) || 
+         (dto == dfrom && loop_heads[bid(to)] == loop_heads[bid(from)]);
+}
+
 /*
  * PRIORITY STRATEGIES
  */
@@ -539,29 +709,29 @@ namespace {
 
 unsigned int ColorsLeftAfterBlock(LiveRange* lr, Block* blk)
 {
-  VectorSet used_colors = RegisterClass::TmpVectorSet(lr->rc);
-  VectorSet vsUsed = Coloring::UsedColors(lr->rc, blk);
-  VectorSet_Union(used_colors, lr->forbidden, vsUsed);
-
-  return Coloring::NumColorsAvailable(lr,used_colors);
+  return Coloring::NumColorsAvailableAfterBlock(lr, blk);
 }
 
+/* picks the choice with the largest nonzero count, the lowest color
+ * on a tie, or the first choice when every count is zero */
 Color FindMaxOrDefault(
-  const std::map<Color,int>& color_count_map,
+  const std::vector<int>& color_count,
   const std::vector<Color>& choices
 )
 {
   using Coloring::NO_COLOR;
-  typedef std::map<Color,int>::const_iterator CCI;
+  typedef std::vector<Color>::const_iterator CI;
 
   Color max_color = NO_COLOR;
-  int max_count = -1;
-  for(CCI cci = color_count_map.begin(); cci != color_count_map.end(); cci++)
+  int max_count = 0;
+  for(CI ci = choices.begin(); ci != choices.end(); ci++)
   {
-    if((*cci).second > max_count)
+    int count = color_count[*ci];
+    if(count > max_count || (count == max_count && count > 0 && 
+                             *ci < max_color))
     {
-      max_count = (*cci).second;
-      max_color = (*cci).first;
+      max_count = count;
+      max_color = *ci;
     }
   }
 
@@ -580,5 +750,30 @@ Color FindMaxOrDefault(
   return color;
 }
 
+/*
+ *============================
+ * GrowSplitWith()
+ *============================
+ * grows the split live range from the start unit using the fringe
+ * functions of the concrete split strategy S. naming S in the calls
+ * binds them statically, the same loop as SplitStrategy::operator()
+ */
+template<class S>
+void GrowSplitWith(S& strategy, 
+                   LiveRange* newlr, LiveRange* origlr, LiveUnit* startunit)
+{
+  strategy.newlr = newlr;
+  strategy.origlr = origlr;
+  ResetIncludeInSplit(startunit);
+
+  SplitStrategy::FringeList fringe_list;
+  fringe_list.push_back(startunit->block);
+  while(!fringe_list.empty())
+  {
+    Block* blk = strategy.S::RemoveFringeNode(fringe_list);
+    strategy.S::ExpandFringeNode(blk, fringe_list);
+  }
+}
+
 }//end anonymous namespace
 
@@ -36,7 +36,8 @@ namespace Chow
     };
     enum HowToSplit {
       CHOW_SPLIT,
-      UP_AND_DOWN_SPLIT
+      UP_AND_DOWN_SPLIT,
+      LOOP_SPLIT
     };
     enum PriorityFunction {
       CLASSIC,
@@ -181,6 +182,16 @@ namespace Chow
       void   ExpandFringeNode(Block*,FringeList&);
     };
 
+    /* 2 */
+    struct LoopSplit : SplitStrategy
+    {
+      FringeList exits; //blocks with edges leaving their loop
+      Block* RemoveFringeNode(FringeList&);
+      void   ExpandFringeNode(Block*,FringeList&);
+      void   ExpandInLoop(Block*, Block*, FringeList&);
+      bool   InSameOrDeeperLoop(Block* from, Block* to);
+    };
+
     /*
      * PRIORITY FUNCTIONS
      */
@@ -229,6 +240,19 @@ namespace Chow
     extern SplitStrategy* how_to_split_strategy;
     extern PriorityFunctionStrategy* priority_strategy;
 
+    /* the allocator calls the strategies through the statically
+     * dispatched entry points below. they switch once per call on the
+     * strategy selected in Params::Algorithm and then invoke the
+     * concrete strategy directly so it can be inlined. the setters
+     * record the selection there as well as in the pointers above,
+     * which remain for code that wants the interface */
+    Priority ComputePriority(LiveRange* lr);
+    bool ShouldSplit(LiveRange* lr);
+    void ResetIncludeInSplit(LiveUnit* startunit);
+    bool IncludeBlockInSplit(LiveRange* lrnew, LiveRange* lrorig, Block*);
+    Color ChooseColor(const LiveRange* lr, const std::vector<Color>&);
+    void GrowSplit(LiveRange* newlr, LiveRange* origlr, LiveUnit* start);
+
     void SetColorChoiceStrategy(ColorChoice cs);
     void SetIncludeInSplitStrategy(IncludeInSplit is);
     void SetWhenToSplitStrategy(WhenToSplit ws);
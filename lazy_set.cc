@@ -1,36 +1,188 @@
-
 #include "lazy_set.h"
 #include "types.h"
 #include "debug.h"
 
 namespace {
   inline bool mem(LazySet::ElemSet* elemset, uint i){
-    assert(i < elemset->size());
-    return ((*elemset)[i]);
+    return elemset->member(i);
+  }
+
+  /* account for a change in the size of a membership set and keep
+   * the peak against what a dense bitmap per set would have used */
+  inline void track(size_t before, size_t after){
+    LazySet::live_bytes += after;
+    LazySet::live_bytes -= before;
+    if(LazySet::live_bytes > LazySet::peak_bytes)
+      LazySet::peak_bytes = LazySet::live_bytes;
+  }
+  inline void track_dense(){
+    size_t dense =
+      (size_t)LazySet::set_count * ((LiveRange::counter + 100 + 7) / 8);
+    if(dense > LazySet::dense_peak_bytes)
+      LazySet::dense_peak_bytes = dense;
+  }
+}
+
+/*------------------------DegreeSet------------------------*/
+DegreeSet::DegreeSet()
+  : count(0), table(NULL), capacity(0)
+{
+}
+
+/* multiplicative hash into the table. ids are dense small
+ * integers so spreading them with a golden ratio multiply is
+ * enough to keep the linear probes short */
+uint DegreeSet::Slot(uint id) const
+{
+  return (id * 2654435761u) & (capacity - 1);
+}
+
+void DegreeSet::Rehash(uint new_capacity)
+{
+  uint* old_table = table;
+  uint old_capacity = capacity;
+
+  table = (uint*)ArenaAlloc::Get(new_capacity * sizeof(uint));
+  capacity = new_capacity;
+  for(uint i = 0; i < capacity; i++){table[i] = EMPTY;}
+
+  if(old_table == NULL)
+  {
+    for(uint i = 0; i < count; i++)
+    {
+      uint s = Slot(small[i]);
+      while(table[s] != EMPTY){s = (s + 1) & (capacity - 1);}
+      table[s] = small[i];
+    }
+  }
+  else
+  {
+    for(uint i = 0; i < old_capacity; i++)
+    {
+      if(old_table[i] == EMPTY) continue;
+      uint s = Slot(old_table[i]);
+      while(table[s] != EMPTY){s = (s + 1) & (capacity - 1);}
+      table[s] = old_table[i];
+    }
   }
-  inline void update(LazySet::ElemSet* elemset, uint i, bool b){
-    assert(i < elemset->size());
-    ((*elemset)[i]) = b;
+}
+
+bool DegreeSet::member(uint id) const
+{
+  if(table == NULL)
+  {
+    for(uint i = 0; i < count; i++){if(small[i] == id) return true;}
+    return false;
   }
+
+  for(uint s = Slot(id); table[s] != EMPTY; s = (s + 1) & (capacity - 1))
+  {
+    if(table[s] == id) return true;
+  }
+  return false;
+}
+
+bool DegreeSet::insert(uint id)
+{
+  assert(id != EMPTY);
+  if(member(id)) return false;
+
+  if(table == NULL)
+  {
+    if(count < SMALL_MAX){small[count++] = id; return true;}
+    Rehash(4 * SMALL_MAX);
+  }
+  else if(2 * (count + 1) > capacity)
+  {
+    //keep the load factor at or below one half
+    Rehash(2 * capacity);
+  }
+
+  uint s = Slot(id);
+  while(table[s] != EMPTY){s = (s + 1) & (capacity - 1);}
+  table[s] = id;
+  count++;
+  return true;
+}
+
+bool DegreeSet::erase(uint id)
+{
+  if(table == NULL)
+  {
+    for(uint i = 0; i < count; i++)
+    {
+      if(small[i] == id){small[i] = small[--count]; return true;}
+    }
+    return false;
+  }
+
+  uint s = Slot(id);
+  while(table[s] != id)
+  {
+    if(table[s] == EMPTY) return false;
+    s = (s + 1) & (capacity - 1);
+  }
+
+  //backward shift deletion so no tombstones are needed: pull
+  //forward any entry in the probe run whose home slot would no
+  //longer reach it across the hole we just made
+  uint hole = s;
+  for(uint j = (hole + 1) & (capacity - 1); 
+      table[j] != EMPTY; 
+      j = (j + 1) & (capacity - 1))
+  {
+    uint home = Slot(table[j]);
+    bool movable = (hole <= j) ? (home <= hole || home > j)
+                               : (home <= hole && home > j);
+    if(movable){table[hole] = table[j]; hole = j;}
+  }
+  table[hole] = EMPTY;
+  count--;
+  return true;
+}
+
+void DegreeSet::clear()
+{
+  table = NULL;
+  capacity = 0;
+  count = 0;
+}
+
+size_t DegreeSet::bytes() const
+{
+  return sizeof(DegreeSet) + capacity * sizeof(uint);
+}
+
+/*------------------------LazySet------------------------*/
+size_t LazySet::live_bytes = 0;
+size_t LazySet::peak_bytes = 0;
+size_t LazySet::dense_peak_bytes = 0;
+uint LazySet::set_count = 0;
+
+void LazySet::ResetMemoryStats()
+{
+  live_bytes = peak_bytes = dense_peak_bytes = set_count = 0;
 }
 
-LazySet::LazySet(Arena arena, int initial_size)
+LazySet::LazySet()
   : real_size(0), out_of_sync(false), seq_id(0)
 {
-  elemset   = new std::vector<bool>(initial_size, false);
-  elemlist  = new ElemList;
+  elemset   = new DegreeSet;
+  elemlist  = ArenaAlloc::New<ElemList>();
+  set_count++;
+  track(0, elemset->bytes());
+  track_dense();
 }
 
 void LazySet::insert(LiveRange* lr)
 {
-  if(lr->id >= elemset->size()){
-      elemset->resize(LiveRange::counter+100,false);
-  };
-  if(!mem(elemset,lr->id))
+  size_t before = elemset->bytes();
+  if(elemset->insert(lr->id))
   {
-    update(elemset,lr->id, true);
+    track(before, elemset->bytes());
+    track_dense();
     elemlist->push_back(lr);
-    real_size++; assert(real_size <= (int)elemset->size());
+    real_size++;
     assert(((int)elemlist->size() == real_size) || out_of_sync);
     seq_id++;
   }
@@ -38,9 +190,8 @@ void LazySet::insert(LiveRange* lr)
 
 void LazySet::erase(LiveRange* lr)
 {
-  if(mem(elemset,lr->id))
+  if(elemset->erase(lr->id))
   {
-    update(elemset,lr->id, false);
     real_size--; assert(real_size >= 0);
     out_of_sync = true;
     seq_id++;
@@ -48,12 +199,14 @@ void LazySet::erase(LiveRange* lr)
 }
 bool LazySet::member(LiveRange* lr)
 {
-  return lr->id < elemset->size() ? mem(elemset,lr->id) : false;
+  return mem(elemset,lr->id);
 }
 
 void LazySet::clear()
 {
-  for(uint i = 0; i < elemset->size(); i++){update(elemset,i,false);}
+  size_t before = elemset->bytes();
+  elemset->clear();
+  track(before, elemset->bytes());
   elemlist->clear();
   real_size = 0;
   out_of_sync = false;
@@ -62,7 +215,6 @@ void LazySet::clear()
 
 int LazySet::size()
 {
-  assert(real_size < (int)elemset->size());
   assert(real_size >= 0);
   return real_size;
 }
@@ -71,7 +223,7 @@ LazySet::iterator LazySet::begin()
 {
   //printf("looking for begin. size: %d, real_size: %d\n", 
   //  elemset->size(), real_size);
-  LRList::iterator start = elemlist->end();
+  ElemList::iterator start = elemlist->end();
   if(real_size == 0)
   {
     elemlist->clear();
@@ -81,10 +233,10 @@ LazySet::iterator LazySet::begin()
   {
     //find the first element in the list that is still in the set and
     //start the iteration from there, erasing expired as we go
-    for(LRList::iterator it = elemlist->begin(); it != elemlist->end();)
+    for(ElemList::iterator it = elemlist->begin(); it != elemlist->end();)
     {
       if(mem(elemset,(*it)->id)){start = it; break;}
-      else{LRList::iterator del = it++; elemlist->erase(del);}
+      else{ElemList::iterator del = it++; elemlist->erase(del);}
     }
   }
 
@@ -5,10 +5,42 @@
 #include <Shared.h>
 #include "live_range.h"
 
-class LazySet {
+/* set of live range ids whose memory scales with the number of
+ * members rather than the number of live ranges in the procedure.
+ * low degree sets keep their ids in a small inline array. once the
+ * set grows past SMALL_MAX members it is promoted to an open
+ * addressed hash table that doubles as needed.
+ */
+class DegreeSet : public ArenaObject {
   public:
-  typedef std::list<LiveRange*> ElemList;
-  typedef std::vector<bool> ElemSet;
+  DegreeSet();
+
+  bool insert(uint id); /* true if id was added */
+  bool erase(uint id);  /* true if id was removed */
+  bool member(uint id) const;
+  void clear();
+  size_t bytes() const;
+
+  private:
+  static const uint SMALL_MAX = 8;
+  static const uint EMPTY = (uint)-1;
+
+  uint small[SMALL_MAX]; /* members while table is NULL */
+  uint count;            /* number of members */
+  uint* table;           /* hashed members once promoted */
+  uint capacity;         /* slots in table, always a power of two */
+
+  uint Slot(uint id) const;
+  void Rehash(uint new_capacity);
+
+  DegreeSet(const DegreeSet&);
+  DegreeSet& operator=(const DegreeSet&);
+};
+
+class LazySet : public ArenaObject {
+  public:
+  typedef std::list<LiveRange*, ArenaAllocator<LiveRange*> > ElemList;
+  typedef DegreeSet ElemSet;
 
   /* fields */
   int real_size; /* number of elements in the set */
@@ -18,7 +50,7 @@ class LazySet {
   int seq_id; /* keep track of when the set changes for out-of-sync reset*/
 
   /* constructor */
-  LazySet(Arena, int max_size);
+  LazySet();
 
   /* methods */
   void insert(LiveRange* lr);
@@ -27,6 +59,13 @@ class LazySet {
   bool member(LiveRange* lr);
   int size();
 
+  /* memory accounting for the membership sets of all LazySets */
+  static size_t live_bytes; /* bytes currently held */
+  static size_t peak_bytes; /* high water mark of live_bytes */
+  static size_t dense_peak_bytes; /* peak for a bitmap over all lrs */
+  static uint set_count;  /* number of LazySets allocated */
+  static void ResetMemoryStats();
+
 
   class LazySetIterator : 
     public std::iterator<std::input_iterator_tag, LiveRange*>
@@ -24,6 +24,8 @@
 #include "reach.h"
 #include "heuristics.h"
 #include "priority.h"
+#include "liveness.h"
+#include "chow.h"
 
 /*------------------MODULE LOCAL DEFINITIONS-------------------*/
 namespace {
@@ -73,32 +75,27 @@ namespace {
   void Def_CollectUniqueUseNames(Variable, std::list<Variable>&);
   Boolean VectorSet_Full(VectorSet vs);
   Boolean VectorSet_Empty(VectorSet vs);
-  bool VectorSet_Intersects(VectorSet y, VectorSet z);
   void AddEdgeExtensionNode(Edge*, LiveRange*, LiveUnit*,SpillType);
   LiveUnit* LiveRange_AddLiveUnit(LiveRange*, LiveUnit*);
   LiveUnit* LiveRange_AddLiveUnitBlock(LiveRange*, Block*);
   LiveUnit* LiveRange_ChooseSplitPoint(LiveRange*);
+  LiveUnit* LiveRange_PlanSplit(LiveRange*, LiveRange*);
+  void LiveRange_SplitSeeds(LiveRange*, unsigned int, 
+                            std::vector<LiveUnit*>&);
   bool LiveRange_IncludeInSplit(LiveRange*, LiveRange*, Block*);
   void LiveRange_AddBlock(LiveRange* lr, Block* b);
+  void LiveRange_ForbidInBlock(LiveRange* lr, Block* b);
   void LiveRange_UpdateAfterSplit(LiveRange*,LiveRange*);
   Boolean LiveRange_EntryPoint(LiveRange* lr, LiveUnit* unit);
   void LiveRange_MarkLoads(LiveRange* lr);
-  void LiveRange_MarkStores(LiveRange* lr);
+  void LiveRange_MarkStores(LiveRange* lr, VectorSet scratch);
   void LiveRange_MarkStores__ORIG(LiveRange* lr);
   void LiveRange_InsertLoad(LiveRange* lr, LiveUnit* unit);
   void LiveRange_InsertStore(LiveRange*lr, LiveUnit* unit);
-  bool inline LiveIn(LRID orig_lrid, Block* blk)
-  {
-    Liveness_Info info = SSA_live_in[bid(blk)];
-    for(LOOPVAR j = 0; j < info.size; j++)
-    {
-      if(orig_lrid == info.names[j])
-      {
-        return true;
-      }
-    }
-    return false;
-  }
+  using Liveness::LiveIn;
+
+  /* load/store marks of a unit, saved across split trials */
+  struct UnitFlags {Boolean need_load, need_store, internal_store;};
 }
 
 /*--------------------BEGIN IMPLEMENTATION---------------------*/
@@ -106,20 +103,95 @@ namespace {
  *============================
  * LiveRange::Init()
  *============================
- * Initialize class variables
+ * Initialize class variables. the live ranges, their units and their
+ * containers all come from an arena of their own, so any live ranges
+ * from an earlier build are released first.
  ***/
 Arena LiveRange::arena = NULL;
 VectorSet LiveRange::tmpbbset = NULL;
 const float LiveRange::UNDEFINED_PRIORITY = 666;
 unsigned int LiveRange::counter = 0;
 const uint LiveRange::MAX_LRS = 10000;
-void LiveRange::Init(Arena arena, unsigned int counter_start)
+void LiveRange::Init(unsigned int counter_start)
 {
-  LiveRange::arena = arena;
+  Release();
+  LiveRange::arena = Arena_Create();
   LiveRange::tmpbbset = VectorSet_Create(arena, block_count+1);
+  ArenaAlloc::Use(arena);
   LiveRange::counter = counter_start;
 }
 
+/*
+ *============================
+ * LiveRange::Release()
+ *============================
+ * Frees every live range along with its units, containers and edge
+ * spill lists by destroying their arena.
+ ***/
+void LiveRange::Release()
+{
+  LRTable::Clear();
+  if(arena == NULL) return;
+  ArenaAlloc::Use(NULL);
+  Arena_Destroy(arena);
+  arena = NULL;
+  tmpbbset = NULL;
+}
+
+/*
+ *============================
+ * LRTable::Reserve()
+ *============================
+ * Makes sure the hot field arrays have a slot for the given LRID.
+ * arrays grow geometrically so splits do not reallocate each time.
+ ***/
+namespace LRTable {
+std::vector<Priority> priority;
+std::vector<Color> color;
+std::vector<Boolean> is_candidate;
+std::vector<int> num_colored_neighbors;
+std::vector<Boolean> simplified;
+std::vector<Coloring::ColorMask> forbidden_mask;
+std::vector<LiveRange*> live_range;
+LRID count = 0;
+
+void Reserve(LRID lrid)
+{
+  assert(lrid != NO_LRID);
+  if(lrid < priority.size()) return;
+
+  uint size = std::max((uint)(2 * priority.size()), (uint)(lrid + 1));
+  priority.resize(size, LiveRange::UNDEFINED_PRIORITY);
+  color.resize(size, Coloring::NO_COLOR);
+  is_candidate.resize(size, FALSE);
+  num_colored_neighbors.resize(size, 0);
+  simplified.resize(size, FALSE);
+  Coloring::ColorMask empty = {{0}};
+  forbidden_mask.resize(size, empty);
+  live_range.resize(size, NULL);
+}
+
+/* makes the live range reachable from its LRID */
+void Add(LiveRange* lr)
+{
+  Reserve(lr->id);
+  live_range[lr->id] = lr;
+  if(lr->id >= count) count = lr->id + 1;
+}
+
+void Clear()
+{
+  priority.clear();
+  color.clear();
+  is_candidate.clear();
+  num_colored_neighbors.clear();
+  simplified.clear();
+  forbidden_mask.clear();
+  live_range.clear();
+  count = 0;
+}
+}
+
 
 /*
  *============================
@@ -129,25 +201,31 @@ void LiveRange::Init(Arena arena, unsigned int counter_start)
  ***/
 LiveRange::LiveRange(RegisterClass::RC reg_class, 
                      LRID lrid, 
-                     Def_Type def_type,
-                     uint current_lr_count)
+                     Def_Type def_type)
 {
   orig_lrid = lrid;
   id = lrid;
   rc = reg_class;
-  priority = UNDEFINED_PRIORITY;
-  color = Coloring::NO_COLOR;
-  bb_list = VectorSet_Create(LiveRange::arena, block_count+1);
+  LRTable::Add(this);
+  priority() = UNDEFINED_PRIORITY;
+  color() = Coloring::NO_COLOR;
+  bb_list = new BlockSet;
   //fear_list = new std::set<LiveRange*, LRcmp>;
-  fear_list = new LazySet(LiveRange::arena, current_lr_count + 100);
-  units = new std::list<LiveUnit*>;
-  unitmap = new std::map<Block*,LiveUnit*>;
+  fear_list = new LazySet;
+  units = ArenaAlloc::New<LiveUnitList>();
+  unitmap = ArenaAlloc::New<UnitMap>();
   forbidden = 
     VectorSet_Create(LiveRange::arena, RegisterClass::NumMachineReg(rc));
-  is_candidate  = TRUE;
+  forbidden_count = (unsigned int*)Arena_GetMemClear(LiveRange::arena, 
+    sizeof(unsigned int) * RegisterClass::NumMachineReg(rc));
+  forbidden_size = 0;
+  is_candidate()  = TRUE;
   type = def_type; 
-  num_colored_neighbors = 0;
+  num_colored_neighbors() = 0;
   is_local = false;
+  unit_benefit_sum = 0.0;
+  unit_call_cost_sum = 0.0;
+  unit_count = 0;
 
   //fields for rematerialization
   rematerializable = false;
@@ -156,7 +234,9 @@ LiveRange::LiveRange(RegisterClass::RC reg_class,
   //fields for optimistic coloring
   simplified_neighbor_count = 0;
   simplified_width = 0;
-  simplified = false;
+  simplified() = FALSE;
+  Coloring::ColorMask empty = {{0}};
+  forbidden_mask() = empty;
 }
 
 /*
@@ -260,8 +340,8 @@ bool LiveRange::IsConstrained() const
  ***/
 void LiveRange::MarkNonCandidateAndDelete()
 {
-  color = Coloring::NO_COLOR;
-  is_candidate = FALSE;
+  color() = Coloring::NO_COLOR;
+  is_candidate() = FALSE;
 
   debug("deleting LR: %d from interference graph", this->id);
   //remove me from all neighbors fear list
@@ -274,7 +354,7 @@ void LiveRange::MarkNonCandidateAndDelete()
 
   //clear the bb_list so that this live range will no longer interfere
   //with any other live ranges
-  VectorSet_Clear(bb_list);
+  bb_list->clear();
 }
 
 /*
@@ -288,32 +368,24 @@ void LiveRange::AssignColor()
 {
   Stats::chowstats.clrColored++;
 
-  color = Coloring::SelectColor(this);
-  is_candidate = FALSE; //no longer need a color
-  assert(((int)color) < RegisterClass::NumMachineReg(rc));
-  debug("assigning color: %d to lr: %d", color, this->id);
+  color() = Coloring::SelectColor(this);
+  is_candidate() = FALSE; //no longer need a color
+  assert(((int)color()) < RegisterClass::NumMachineReg(rc));
+  debug("assigning color: %d to lr: %d", color(), this->id);
 
-  //update the interfering live ranges forbidden set
   for(LazySet::iterator it = fear_list->begin(); it != fear_list->end(); it++)
   {
-    LiveRange* intf_lr = *it;
-    for(int i = 0; i < RegisterClass::RegWidth(type); i++)
-    {
-      VectorSet_Insert(intf_lr->forbidden, color+i);
-      debug("adding color: %d to forbid list for LR: %d",color+i,intf_lr->id);
-    }
-    intf_lr->num_colored_neighbors++;
+    (*it)->num_colored_neighbors()++;
   }
 
   //update the basic block taken set and add loads and stores
   for(LiveRange::iterator it = begin(); it != end(); it++)
   {
     LiveUnit* unit = *it;
-    VectorSet vs = Coloring::UsedColors(this->rc, unit->block);
-    assert(!VectorSet_Member(vs, color));
-    for(int i = 0; i < RegisterClass::RegWidth(type); i++)
-      VectorSet_Insert(vs, color+i);
-    Coloring::SetColor(unit->block, this->id, color);
+    assert(!VectorSet_Member(Coloring::UsedColors(rc, unit->block), color()));
+    Coloring::UseColor(rc, unit->block, color(), RegisterClass::RegWidth(type));
+    Coloring::SetColor(unit->block, this->id, color());
+    LiveRange_ForbidInBlock(this, unit->block);
 
     // ----------------  LOAD STORE OPTIMIZATION -----------------
     if(Params::Algorithm::move_loads_and_stores)
@@ -428,7 +500,7 @@ void LiveRange::AssignColor()
 LiveUnit* LiveRange::LiveUnitForBlock(Block* b) const
 {
   LiveUnit* unit = NULL;
-  std::map<Block*,LiveUnit*>::iterator elem = unitmap->find(b);
+  UnitMap::iterator elem = unitmap->find(b);
   if(elem != unitmap->end()){unit = (*elem).second;}
   return unit;
 }
@@ -441,7 +513,7 @@ LiveUnit* LiveRange::LiveUnitForBlock(Block* b) const
  */
 bool LiveRange::ContainsBlock(Block* blk) const
 {
-  return VectorSet_Member(bb_list, bid(blk));
+  return bb_list->member(bid(blk));
 }
 
 /*
@@ -452,10 +524,45 @@ bool LiveRange::ContainsBlock(Block* blk) const
  * range.
  */ 
 void LiveRange::MarkLoadsAndStores()
+{
+  MarkLoadsAndStores(LiveRange::tmpbbset);
+}
+
+/* same as above but with caller supplied scratch space for the block
+ * set so several live ranges can be marked at once */
+void LiveRange::MarkLoadsAndStores(VectorSet scratch)
 {
   LiveRange_MarkLoads(this);
-  LiveRange_MarkStores(this);
+  LiveRange_MarkStores(this, scratch);
   //LiveRange_MarkStores__ORIG(this);
+  RefreshPriorityTerms();
+}
+
+/*
+ *=================================
+ * LiveRange::RefreshPriorityTerms
+ *=================================
+ * Recomputes the cached priority terms of every unit and the sums
+ * the priority functions read. The terms depend on the load and store
+ * marks and on which predecessors of a unit are in the live range, so
+ * a unit moving in or out can change the terms of its neighbors. The
+ * sums are therefore only rebuilt here, in O(units), whenever the
+ * marks are recomputed. Nothing is cached until the loop nesting
+ * depths are known.
+ */ 
+void LiveRange::RefreshPriorityTerms()
+{
+  if(Globals::depths == NULL) return;
+  unit_benefit_sum = 0.0;
+  unit_call_cost_sum = 0.0;
+  for(LiveRange::iterator it = begin(); it != end(); it++)
+  {
+    LiveUnit* unit = *it;
+    Chow::PriorityFuns::UnitTerms(this, unit, 
+                                  &unit->prio_benefit, &unit->prio_call_cost);
+    unit_benefit_sum += unit->prio_benefit;
+    unit_call_cost_sum += unit->prio_call_cost;
+  }
 }
 
 
@@ -521,6 +628,27 @@ unsigned int LiveRange::RegWidth() const
   return RegisterClass::RegWidth(type);
 }
 
+/*
+ *================================
+ * LiveRange::CallWeight()
+ *================================
+ * number of calls this live range is live across, weighted by the
+ * loop depth of the block containing the call
+ ***/
+float LiveRange::CallWeight() const
+{
+  using Params::Algorithm::loop_depth_weight;
+  float weight = 0.0;
+  for(iterator it = begin(); it != end(); it++)
+  {
+    LiveUnit* lu = *it;
+    if(lu->calls > 0)
+      weight += lu->calls * 
+                pow(loop_depth_weight, Globals::depths[bid(lu->block)]);
+  }
+  return weight;
+}
+
 /*
  *=============================
  * LiveRange::InterferesWith()
@@ -535,9 +663,7 @@ Boolean LiveRange::InterferesWith(LiveRange* lr2) const
   {
     return FALSE;
   }
-  return VectorSet_Intersects(bb_list, lr2->bb_list);
-  //VectorSet_Intersect(LiveRange::tmpbbset, bb_list, lr2->bb_list);
-  //return (!VectorSet_Empty(LiveRange::tmpbbset));
+  return bb_list->intersects(*(lr2->bb_list));
 }
 
 /*
@@ -549,7 +675,7 @@ Boolean LiveRange::InterferesWith(LiveRange* lr2) const
  */ 
 Boolean LiveRange::HasColorAvailable() const
 {
-  return (Coloring::IsColorAvailable(this, forbidden));
+  return (Coloring::IsColorAvailable(this));
 }
 
 /*
@@ -565,14 +691,17 @@ Boolean LiveRange::IsEntirelyUnColorable() const
   //throughout the entire length of the live range (i.e. each live
   //unit has no available registers). we need to have a mapping of
   //basic blocks to used registers for that block in order to see
-  //which registers are available.
+  //which registers are available. a color missing from the forbidden
+  //set is free in every block so the per block check can be skipped
+  bool free_everywhere = HasColorAvailable();
   for(LiveRange::iterator it = begin(); it != end(); it++)
   {
     LiveUnit* unit = *it;
     //must have a free register where we have a def or a use
     if(unit->defs > 0 || unit->uses > 0)
     {
-      if(Coloring::IsColorAvailable(this, unit->block)) return false;
+      if(free_everywhere || 
+         Coloring::IsColorAvailable(this, unit->block)) return false;
     }
   }
 
@@ -628,12 +757,13 @@ LiveRange* LiveRange::Split()
   LiveRange* newlr = Mitosis();
 
   //chose the live unit that will start the new live range
-  LiveUnit* startunit = LiveRange_ChooseSplitPoint(this);
+  LiveUnit* startunit = (Params::Algorithm::split_candidates > 1) ?
+    LiveRange_PlanSplit(this, newlr) : LiveRange_ChooseSplitPoint(this);
   assert(startunit != NULL);
 
   debug("adding block: %s to  lr'", bname(startunit->block));
   TransferLiveUnitTo(newlr, startunit);
-  (*Chow::Heuristics::how_to_split_strategy)(newlr, this, startunit);
+  Chow::Heuristics::GrowSplit(newlr, this, startunit);
 /*
   Chow::Heuristics::include_in_split_strategy->Reset(startunit);
 
@@ -663,7 +793,6 @@ LiveRange* LiveRange::Split()
   {
     Chow::Extensions::Trim(this);
     Chow::Extensions::Trim(newlr);
-    newlr->RebuildForbiddenList();
   }
 
   LiveRange_UpdateAfterSplit(newlr, this);
@@ -703,6 +832,7 @@ LiveRange::AddLiveUnitForBlock(Block* b,
   unit->block = b;
   unit->uses = stat.uses;
   unit->defs = stat.defs;
+  unit->calls = stat.calls;
   unit->start_with_def = stat.start_with_def;
   unit->internal_store = FALSE;
   unit->orig_name = orig_name;
@@ -720,8 +850,8 @@ LiveRange::AddLiveUnitForBlock(Block* b,
 Priority LiveRange::ComputePriority()
 {
   //priority = Chow::PriorityFuns::Classic(this);
-  priority = (*Chow::Heuristics::priority_strategy)(this);
-  return priority;
+  priority() = Chow::Heuristics::ComputePriority(this);
+  return priority();
 }
 
 /*
@@ -733,8 +863,8 @@ Priority LiveRange::ComputePriority()
  ***/
 Priority LiveRange::GetPriority()
 {
-  if(priority == UNDEFINED_PRIORITY) ComputePriority();
-  return priority;
+  if(priority() == UNDEFINED_PRIORITY) ComputePriority();
+  return priority();
 }
 
 /*
@@ -746,18 +876,16 @@ Priority LiveRange::GetPriority()
  */
 LiveRange* LiveRange::Mitosis()
 {
-  LiveRange* newlr = new LiveRange(rc, NO_LRID, type, counter);
+  LRID id = LiveRange::counter++;
+  LiveRange* newlr = new LiveRange(rc, id, type);
   newlr->orig_lrid = orig_lrid;
-  newlr->id = LiveRange::counter++;
-  newlr->is_candidate = TRUE;
-  newlr->type = type;
   newlr->blockmap = blockmap;
   newlr->splits =  splits;
   newlr->is_local =  is_local;
 
   //some sanity checks
-  assert(color == Coloring::NO_COLOR);
-  assert(is_candidate == TRUE);
+  assert(color() == Coloring::NO_COLOR);
+  assert(is_candidate() == TRUE);
 
   return newlr;
 }
@@ -792,12 +920,14 @@ void LiveRange::TransferLiveUnitTo(LiveRange* to, LiveUnit* unit)
 void LiveRange::RemoveLiveUnit(LiveUnit* unit)
 {
   //remove from the basic block set
-  VectorSet_Delete(bb_list, bid(unit->block));
+  bb_list->erase(bid(unit->block));
 
-  std::list<LiveUnit*>::iterator elem;
+  LiveUnitList::iterator elem;
   elem = find(begin(), end(), unit);
   if(elem != end())
   {
+    Coloring::AllowUsedColors(this, unit->block);
+    unit_count--;
     unitmap->erase((*elem)->block);
     blockmap->erase(bid((*elem)->block));
     units->erase(elem);
@@ -808,16 +938,17 @@ void LiveRange::RemoveLiveUnit(LiveUnit* unit)
  *==================================
  * LiveRange::RebuildForbiddenList()
  *==================================
- *
+ * recomputes the forbidden set and its counts from scratch. the set is
+ * kept current as units come and go, so this is only needed if the
+ * counts are suspect
  ***/
 void LiveRange::RebuildForbiddenList()
 {
-  VectorSet_Clear(forbidden);
+  Coloring::ClearForbidden(this);
   for(LiveRange::iterator it = begin(); it != end(); it++)
   {
     LiveUnit* unit = *it;
-    VectorSet vsUsed = Coloring::UsedColors(rc, unit->block);
-    VectorSet_Union(forbidden, forbidden, vsUsed);
+    Coloring::ForbidUsedColors(this, unit->block);
   }
 }
 
@@ -837,6 +968,7 @@ LiveUnit* LiveRange_AddLiveUnit(LiveRange* lr, LiveUnit* unit)
 
   lr->units->push_back(unit);
   lr->unitmap->insert(std::make_pair(unit->block, unit));
+  lr->unit_count++;
   return unit;
 }
 
@@ -851,7 +983,7 @@ void AddEdgeExtensionNode(Edge* e, LiveRange* lr, LiveUnit* unit,
     //create and add the edge extension
     ee = (Edge_Extension*) 
       Arena_GetMemClear(LiveRange::arena, sizeof(Edge_Extension));
-    ee->spill_list = new std::list<MovedSpillDescription>;
+    ee->spill_list = ArenaAlloc::New<SpillList>();
     edgPred->edge_extension = ee;
   }
 
@@ -860,7 +992,7 @@ void AddEdgeExtensionNode(Edge* e, LiveRange* lr, LiveUnit* unit,
   msd.lr = lr;
   msd.spill_type = spillType;
   msd.orig_blk = unit->block;
-  msd.mreg = RegisterClass::MachineRegForColor(lr->rc, lr->color);
+  msd.mreg = RegisterClass::MachineRegForColor(lr->rc, lr->color());
   ee->spill_list->push_back(msd);
 }
 
@@ -917,8 +1049,8 @@ void LiveRange_InsertStore(LiveRange*lr, LiveUnit* unit)
 void LiveRange_UpdateAfterSplit(LiveRange* newlr, LiveRange* origlr)
 {
   //reset count of colored neighbors and recompte this below
-  newlr->num_colored_neighbors = 0;
-  origlr->num_colored_neighbors = 0;
+  newlr->num_colored_neighbors() = 0;
+  origlr->num_colored_neighbors() = 0;
 
   //rebuild interferences of those live ranges that interfere with 
   //the original live range. they may now interfere with the new live
@@ -927,12 +1059,12 @@ void LiveRange_UpdateAfterSplit(LiveRange* newlr, LiveRange* origlr)
       it != origlr->fear_list->end(); it++)
   {
     LiveRange* fearlr = *it;
-    bool neighbor_colored = (fearlr->color != Coloring::NO_COLOR);
+    bool neighbor_colored = (fearlr->color() != Coloring::NO_COLOR);
     //update newlr interference
     if(newlr->InterferesWith(fearlr))
     {
       newlr->AddInterference(fearlr);
-      if(neighbor_colored) newlr->num_colored_neighbors++;
+      if(neighbor_colored) newlr->num_colored_neighbors()++;
     }
 
     //update origlr interference
@@ -945,7 +1077,7 @@ void LiveRange_UpdateAfterSplit(LiveRange* newlr, LiveRange* origlr)
     }
     else //interferes so just increment iterator normally
     {
-      if(neighbor_colored) origlr->num_colored_neighbors++;
+      if(neighbor_colored) origlr->num_colored_neighbors()++;
     }
   }
 
@@ -955,15 +1087,10 @@ void LiveRange_UpdateAfterSplit(LiveRange* newlr, LiveRange* origlr)
   origlr->MarkLoadsAndStores();
 
 
-  //removing live units means we need to update the forbidden list
-  //only do this for the orig live range since the new live range
-  //keeps track as it goes
-  origlr->RebuildForbiddenList();
-
   //reset the priorites on the split live ranges since they are no
   //longer current. they will be recomputed if needed
-  newlr->priority  = LiveRange::UNDEFINED_PRIORITY;
-  origlr->priority = LiveRange::UNDEFINED_PRIORITY;
+  newlr->priority()  = LiveRange::UNDEFINED_PRIORITY;
+  origlr->priority() = LiveRange::UNDEFINED_PRIORITY;
 }
 
  
@@ -975,9 +1102,31 @@ void LiveRange_UpdateAfterSplit(LiveRange* newlr, LiveRange* origlr)
  */
 void LiveRange_AddBlock(LiveRange* lr, Block* b)
 {
-  VectorSet_Insert(lr->bb_list, bid(b));
-  VectorSet vsUsed = Coloring::UsedColors(lr->rc, b);
-  VectorSet_Union(lr->forbidden, lr->forbidden, vsUsed);
+  lr->bb_list->insert(bid(b));
+  Coloring::ForbidUsedColors(lr, b);
+}
+
+/*
+ *============================
+ * LiveRange_ForbidInBlock()
+ *============================
+ * counts the color just assigned to +lr+ in the forbidden sets of the
+ * other live ranges of its class that hold the block. a unit stays in
+ * Chow::live_units after it is trimmed away, so only the units whose
+ * live range still contains the block are counted
+ */
+void LiveRange_ForbidInBlock(LiveRange* lr, Block* b)
+{
+  std::vector<LiveUnit*>& units = Chow::live_units[bid(b)];
+  for(unsigned int i = 0; i < units.size(); i++)
+  {
+    LiveRange* intf_lr = units[i]->live_range;
+    if(intf_lr == lr || intf_lr->rc != lr->rc) continue;
+    if(!intf_lr->ContainsBlock(b)) continue;
+    Coloring::ForbidColor(intf_lr, lr->color(), lr->RegWidth());
+    debug("adding color: %d to forbid list for LR: %d",
+          lr->color(), intf_lr->id);
+  }
 }
 
 
@@ -1025,6 +1174,112 @@ LiveUnit* LiveRange_ChooseSplitPoint(LiveRange* lr)
   return startunit;
 }
 
+/*
+ *============================
+ * LiveRange_SplitSeeds()
+ *============================
+ * Collects up to +max+ units that could start a split. The unit
+ * LiveRange_ChooseSplitPoint() would pick comes first, followed by
+ * the other units with a free color that start with a def and then
+ * those that have a use.
+ */ 
+void LiveRange_SplitSeeds(LiveRange* lr, unsigned int max,
+                          std::vector<LiveUnit*>& seeds)
+{
+  seeds.clear();
+  seeds.push_back(LiveRange_ChooseSplitPoint(lr));
+  for(int pass = 0; pass < 2 && seeds.size() < max; pass++)
+  {
+    for(LiveRange::iterator it = lr->begin(); 
+        it != lr->end() && seeds.size() < max; it++)
+    {
+      LiveUnit* unit = *it;
+      bool wanted = (pass == 0) ? unit->start_with_def : unit->uses > 0;
+      if(wanted && Coloring::IsColorAvailable(lr, unit->block) &&
+         find(seeds.begin(), seeds.end(), unit) == seeds.end())
+      {
+        seeds.push_back(unit);
+      }
+    }
+  }
+}
+
+/*
+ *============================
+ * LiveRange_PlanSplit()
+ *============================
+ * Tries each split seed by growing the split from it into +newlr+
+ * and then putting the units back. With -t the piece is trimmed the
+ * same way Split() trims it, so the trial scores the piece that would
+ * be kept. A trial is scored by the priority of the piece it carves
+ * out. That priority already counts the loads and stores the piece
+ * needs, weighted by loop depth. On a tie the larger piece wins since
+ * it leaves less behind to split again. The live range is left as it
+ * was and the best seed is returned.
+ *
+ * The effect of a trial on the neighbors is not scored. It depends
+ * on the color the piece gets, which is only known once it is picked
+ * from the constrained list, and measuring it would mean updating
+ * the interference and forbidden sets of every neighbor for every
+ * trial. That update is most of the cost of a split.
+ */ 
+LiveUnit* LiveRange_PlanSplit(LiveRange* lr, LiveRange* newlr)
+{
+  std::vector<LiveUnit*> seeds;
+  LiveRange_SplitSeeds(lr, Params::Algorithm::split_candidates, seeds);
+  if(seeds.size() == 1) return seeds[0];
+
+  //the trials reorder the units and mark loads and stores on them so
+  //remember how things looked before
+  std::vector<LiveUnit*> order(lr->begin(), lr->end());
+  std::vector<UnitFlags> flags(order.size());
+  for(unsigned int i = 0; i < order.size(); i++)
+  {
+    flags[i].need_load = order[i]->need_load;
+    flags[i].need_store = order[i]->need_store;
+    flags[i].internal_store = order[i]->internal_store;
+  }
+
+  LiveUnit* best = seeds[0];
+  Priority best_prio = 0.0;
+  unsigned int best_size = 0;
+  for(unsigned int s = 0; s < seeds.size(); s++)
+  {
+    lr->TransferLiveUnitTo(newlr, seeds[s]);
+    Chow::Heuristics::GrowSplit(newlr, lr, seeds[s]);
+    if(Params::Algorithm::trim_useless_blocks)
+      Chow::Extensions::Trim(newlr, lr);
+    newlr->MarkLoadsAndStores();
+    Priority prio = Chow::Heuristics::ComputePriority(newlr);
+    unsigned int size = newlr->unit_count;
+    debug("split seed %s for LR: %d gives %d units, priority %.3f",
+          bname(seeds[s]->block), lr->id, size, prio);
+    if(s == 0 || prio > best_prio || (prio == best_prio && size > best_size))
+    {
+      best = seeds[s];
+      best_prio = prio;
+      best_size = size;
+    }
+
+    //undo the trial
+    std::vector<LiveUnit*> moved(newlr->begin(), newlr->end());
+    for(unsigned int i = 0; i < moved.size(); i++)
+      newlr->TransferLiveUnitTo(lr, moved[i]);
+    lr->units->clear();
+    for(unsigned int i = 0; i < order.size(); i++)
+    {
+      lr->units->push_back(order[i]);
+      order[i]->need_load = flags[i].need_load;
+      order[i]->need_store = flags[i].need_store;
+      order[i]->internal_store = flags[i].internal_store;
+    }
+    lr->RefreshPriorityTerms();
+  }
+
+  if(best != seeds[0]) Stats::chowstats.cSplitSeedsImproved++;
+  return best;
+}
+
 /*
  *============================
  * LiveRange_IncludeInSplit()
@@ -1035,8 +1290,7 @@ bool LiveRange_IncludeInSplit(LiveRange* newlr,
                               LiveRange* origlr,
                               Block* b)
 {
-  return 
-    (*Chow::Heuristics::include_in_split_strategy)(newlr,origlr,b);
+  return Chow::Heuristics::IncludeBlockInSplit(newlr,origlr,b);
 }
 
 
@@ -1072,7 +1326,7 @@ void LiveRange_MarkLoads(LiveRange* lr)
  *=================================
  * Calculates where to place the needed stores 
  */
-void LiveRange_MarkStores(LiveRange* lr)
+void LiveRange_MarkStores(LiveRange* lr, VectorSet scratch)
 {
   debug("*** MARKING STORES for LR: %d ***\n", lr->id);
   std::vector<Block*> def_blocks;
@@ -1088,26 +1342,21 @@ void LiveRange_MarkStores(LiveRange* lr)
   if(def_blocks.size() > 0)
   {
     //build union of all reaching sets for any block containing a def
-    VectorSet_Clear(LiveRange::tmpbbset);
+    VectorSet_Clear(scratch);
     for(unsigned int i = 0; i < def_blocks.size(); i++)
     {
       VectorSet_Union(
-        LiveRange::tmpbbset, 
-        LiveRange::tmpbbset, 
+        scratch, 
+        scratch, 
         Reach::ReachableBlocks(def_blocks[i]));
     }
-    //interset with this live ranges blocks to limit our scope
-    VectorSet_Intersect(
-      LiveRange::tmpbbset, 
-      LiveRange::tmpbbset, 
-      lr->bb_list);
-
-    //check all blocks a def reaches to see if a store is needed
+    //check all blocks a def reaches to see if a store is needed. we
+    //only look at the blocks of this live range so there is no need
+    //to intersect the reaching set with the whole block list
     for(LiveRange::iterator it = lr->begin(); it != lr->end(); it++)
     {
       LiveUnit* unit = *it;
-      if(!VectorSet_Member(LiveRange::tmpbbset, bid(unit->block)))
-        continue;
+      if(!VectorSet_Member(scratch, bid(unit->block))) continue;
 
       Boolean only_internal_store = TRUE; //keep track of why store needed
       unit->internal_store = FALSE; //reset to false, make true later
@@ -1132,22 +1381,15 @@ void LiveRange_MarkStores(LiveRange* lr)
         }
         else //unit is an exit point of the live range
         {
-          //test for liveness
-          Liveness_Info info = SSA_live_in[bid(blkSucc)];
-          for(LOOPVAR j = 0; j < info.size; j++)
+          //test for liveness, def is live along this path
+          if(LiveIn(lr->orig_lrid, blkSucc))
           {
-            //debug("LIVE_IN: %d in %s",info.names[j], bname(blkSucc));
-            //def is live along this path
-            if(lr->orig_lrid == info.names[j])
-            {
-              unit->need_store = TRUE;
-              only_internal_store = FALSE;
-              debug("store needed for lr: %d block(%s) "
-                    "because it is live in at successor %s(%d)\n",
-                    lr->id, bname(unit->block), 
-                    bname(blkSucc), bid(blkSucc));
-              break;
-            }
+            unit->need_store = TRUE;
+            only_internal_store = FALSE;
+            debug("store needed for lr: %d block(%s) "
+                  "because it is live in at successor %s(%d)\n",
+                  lr->id, bname(unit->block), 
+                  bname(blkSucc), bid(blkSucc));
           }
           if(!unit->need_store) {debug("NO STORE: %d\n",unit->orig_name);}
         }//else, succ not in live range
@@ -1221,22 +1463,15 @@ debug("*** MARKING STORES for LR: %d ***\n", lr->id);
           if(find(def_list.begin(), def_list.end(), def) !=
               def_list.end())
           {
-            //test for liveness
-            Liveness_Info info = SSA_live_in[bid(blkSucc)];
-            for(LOOPVAR j = 0; j < info.size; j++)
+            //test for liveness, def is live along this path
+            if(LiveIn(lr->orig_lrid, blkSucc))
             {
-              //debug("LIVE_IN: %d in %s",info.names[j], bname(blkSucc));
-              //def is live along this path
-              if(lr->orig_lrid == info.names[j])
-              {
-                unit->need_store = TRUE;
-                only_internal_store = FALSE;
-                debug("store needed for lr: %d block(%s) "
-                      "because it is live in at successor %s(%d)\n",
-                      lr->id, bname(unit->block), 
-                      bname(blkSucc), bid(blkSucc));
-                break;
-              }
+              unit->need_store = TRUE;
+              only_internal_store = FALSE;
+              debug("store needed for lr: %d block(%s) "
+                    "because it is live in at successor %s(%d)\n",
+                    lr->id, bname(unit->block), 
+                    bname(blkSucc), bid(blkSucc));
             }
             if(!unit->need_store) {debug("NO STORE: %d\n",unit->orig_name);}
           }
@@ -1349,24 +1584,6 @@ Boolean VectorSet_Empty(VectorSet vs)
   return (VectorSet_Size(vs) == 0);
 }
 
-bool VectorSet_Intersects(VectorSet y, VectorSet z)
-{
-  Unsigned_Int4 *yLast;
-  Unsigned_Int4 *yp;        /* Current location in y */
-  Unsigned_Int4 *zp;        /* Current location in z */
-
-  /* Initialize the pointers. */
-  yp = y->word;
-  zp = z->word;
-  yLast = y->word + y->word_count;
-
-  /* Union the bit vectors. */
-  while (yp < yLast) if(*yp++ & *zp++) return true;
-
-  return false;
-
-} /* VectorSet_Intersect. */
-
 
 
 }//end anonymous namespace
@@ -7,10 +7,13 @@
 #include <vector>
 #include <map>
 #include "types.h"
+#include "arena_alloc.h"
 #include "debug.h"
 #include "stats.h"
 #include "rc.h"
+#include "color.h"
 #include "lazy_set.h"
+#include "block_set.h"
 
 /*--------------------------FORWARD DEFS--------------------------*/
 /* forward definition of a comparison object used by the std::set
@@ -22,52 +25,119 @@ struct LRcmp;
 struct LiveUnit;
 class LazySet;
 
+typedef float Priority;
+
+/*----------------------ARENA CONTAINERS--------------------------*/
+/* containers owned by live ranges and edges draw from the arena */
+typedef std::list<LiveUnit*, ArenaAllocator<LiveUnit*> > LiveUnitList;
+typedef std::map<Block*, LiveUnit*, std::less<Block*>,
+                 ArenaAllocator<std::pair<Block* const, LiveUnit*> > > 
+  UnitMap;
+typedef std::map<unsigned int, LiveRange*, std::less<unsigned int>,
+                 ArenaAllocator<std::pair<const unsigned int, LiveRange*> > >
+  BlockMap;
+typedef std::vector<LiveRange*, ArenaAllocator<LiveRange*> > SplitVec;
+
+/*-------------------LIVE RANGE HOT FIELD TABLE--------------------*/
+/* the scalars read by the priority scan, the constrained list checks
+ * and optimistic simplification live in parallel arrays indexed by
+ * LRID instead of inside each LiveRange. the constrained lists hold
+ * LRIDs, so those passes walk a few dense arrays and only load a
+ * LiveRange when they need more than its hot fields. a LiveRange
+ * reaches its own entries through the accessors below. */
+namespace LRTable {
+  extern std::vector<Priority> priority;
+  extern std::vector<Color> color;
+  extern std::vector<Boolean> is_candidate;
+  extern std::vector<int> num_colored_neighbors;
+  extern std::vector<Boolean> simplified;
+  extern std::vector<Coloring::ColorMask> forbidden_mask;
+  extern std::vector<LiveRange*> live_range; /* the object for an LRID */
+  extern LRID count; /* LRIDs in use, the slots above may be more */
+
+  void Clear();
+  void Reserve(LRID lrid);
+  void Add(LiveRange* lr);
+}
+
+/* Chow::live_ranges is a view over the live_range column of the table
+ * rather than a vector of its own */
+struct LiveRangeView
+{
+  typedef LRID size_type;
+  inline LiveRange*& operator[](LRID lrid) const
+    {return LRTable::live_range[lrid];}
+  inline size_type size() const {return LRTable::count;}
+};
+
 /*-------------------LIVE RANGE DATA STRUCTURE--------------------*/
 /* a live range is the unit of allocation for the register allocator.
  * these will be assigned a color */
-typedef float Priority;
-struct LiveRange
+struct LiveRange : public ArenaObject
 {
   /* class varaibles */
   static const uint MAX_LRS;
-  static void Init(Arena,unsigned int); /* class initialization function */
+  static void Init(unsigned int); /* class initialization function */
+  static void Release(); /* drops all live ranges at once */
   static Arena arena; /* for memory allocation needs */
   static VectorSet tmpbbset; /* for memory allocation needs */
   static const float UNDEFINED_PRIORITY;
   static unsigned int counter;
 
   /* constructor */
-  LiveRange(RegisterClass::RC rc, LRID lrid, Def_Type, uint num_lrs);
+  LiveRange(RegisterClass::RC rc, LRID lrid, Def_Type);
 
   /* fields */
-  VectorSet bb_list;  /* basic blocks making up this LR */ 
+  BlockSet* bb_list;  /* basic blocks making up this LR */ 
                       /* set of live range interferences */
   //std::set<LiveRange*, LRcmp> *fear_list;
   LazySet *fear_list;
   VectorSet forbidden; /* forbidden colors for this LR */
-  std::list<LiveUnit*> *units;  /* live units making up this LR */ 
-  Color color;  /* color assigned to this LR */
+  /* number of blocks of this LR using each color, see color.cc */
+  unsigned int* forbidden_count;
+  unsigned int forbidden_size; /* number of forbidden colors */
+  LiveUnitList *units;  /* live units making up this LR */ 
   Variable orig_lrid;  /* original variable for this live range */
   Variable id;  /* unique id for this live range */
-  Priority priority; /* priority for this to be in a live range */
-  Boolean is_candidate; /* is possible to store this in a register */
   Def_Type type;
   RegisterClass::RC rc;
   bool rematerializable;
   Operation* remat_op;
-  int num_colored_neighbors;
   bool is_local;
   int simplified_neighbor_count;
   int simplified_width;
-  bool simplified; //been pulled from the graph
 
   /* maps from block id --> live range, for keeping track of splits */
-  std::map<unsigned int, LiveRange*> *blockmap; 
+  BlockMap *blockmap; 
   /* keeps track of all the live range split from this one */
-  std::vector<LiveRange*> *splits; 
+  SplitVec *splits; 
   bool zero_occurs;
   /* maps from block --> live unit for that block */
-  std::map<Block*, LiveUnit*> *unitmap; 
+  UnitMap *unitmap; 
+  /* sums of the cached unit priority terms, rebuilt with the load and
+   * store marks, and the number of units */
+  double unit_benefit_sum;
+  double unit_call_cost_sum;
+  unsigned int unit_count;
+
+  /* hot fields, stored in LRTable */
+  /* color assigned to this LR */
+  inline Color& color() const 
+    {return LRTable::color[id];}
+  /* priority for this to be in a live range */
+  inline Priority& priority() const 
+    {return LRTable::priority[id];}
+  /* is possible to store this in a register */
+  inline Boolean& is_candidate() const 
+    {return LRTable::is_candidate[id];}
+  inline int& num_colored_neighbors() const 
+    {return LRTable::num_colored_neighbors[id];}
+  /* been pulled from the graph */
+  inline Boolean& simplified() const 
+    {return LRTable::simplified[id];}
+  /* mask copy of the forbidden set for the coloring kernels */
+  inline Coloring::ColorMask& forbidden_mask() const 
+    {return LRTable::forbidden_mask[id];}
 
   /* methods */
   void AddInterference(LiveRange* other);
@@ -77,6 +147,8 @@ struct LiveRange
   LiveUnit* LiveUnitForBlock(Block* b) const;
   bool ContainsBlock(Block* b) const;
   void MarkLoadsAndStores();
+  void MarkLoadsAndStores(VectorSet scratch);
+  void RefreshPriorityTerms();
   Opcode_Names LoadOpcode() const;
   Opcode_Names StoreOpcode() const;
   Opcode_Names CopyOpcode() const;
@@ -92,12 +164,13 @@ struct LiveRange
   void RebuildForbiddenList();
   void RemoveLiveUnit(LiveUnit*);
   unsigned int RegWidth() const;
+  float CallWeight() const;
   bool IsZeroOccurrence() const;
   Priority GetPriority();
 
   /* iterators */
   /* for live units in this live range */
-  typedef std::list<LiveUnit*>::iterator iterator;
+  typedef LiveUnitList::iterator iterator;
   iterator begin() const;
   iterator end() const;
 };
@@ -137,9 +210,11 @@ struct MovedSpillDescription
 
 /* edge extension must be defined to attach this on edges so that we
  * can do code motion */
+typedef std::list<MovedSpillDescription, 
+                  ArenaAllocator<MovedSpillDescription> > SpillList;
 struct edge_extension
 {
-  std::list<MovedSpillDescription>* spill_list;
+  SpillList* spill_list;
 };
 
 #endif
@@ -21,12 +21,16 @@ struct LiveUnit
   Boolean start_with_def;
   int uses;
   int defs;
+  int calls; /* calls the live range is live across in this block */
   Block* block;
   Variable orig_name;
   std::list<LiveUnit*> *lr_units;
   std::list<LiveUnit*> *bb_units;
   bool mark;
   LiveRange* live_range;
+  /* cached priority terms, refreshed by LiveRange::RefreshPriorityTerms */
+  double prio_benefit;   /* savings less the load and store costs */
+  double prio_call_cost; /* cost of saving around calls */
 }; 
 
 LiveUnit* LiveUnit_Alloc(Arena);
@@ -0,0 +1,158 @@
+/* liveness.cc
+ *
+ * per block membership index over the original live range ids for
+ * the SSA live in and live out sets.
+ */
+
+/*-----------------------MODULE INCLUDES-----------------------*/
+#include <SSA.h>
+#include <algorithm>
+#include "liveness.h"
+#include "mapping.h"
+#include "debug.h"
+
+/*------------------MODULE LOCAL DEFINITIONS-------------------*/
+namespace {
+typedef unsigned long Word;
+const Unsigned_Int WORD_BITS = sizeof(Word) * 8;
+
+/* above this many bytes per direction we keep sorted lists instead of
+ * a bit matrix so huge procedures do not pay blocks*lrs bits */
+const size_t MAX_MATRIX_BYTES = 32 * 1024 * 1024;
+
+Unsigned_Int num_lrs = 0;
+Unsigned_Int words_per_block = 0;
+
+/* dense form: one row of bits per block */
+Word* live_in_bits = NULL;
+Word* live_out_bits = NULL;
+
+/* sparse form: sorted unique lrids per block, binary searched */
+LRID** live_in_list = NULL;
+LRID** live_out_list = NULL;
+Unsigned_Int* live_in_size = NULL;
+Unsigned_Int* live_out_size = NULL;
+
+/* maps one entry of a liveness set to its lrid. live in is already in
+ * the live range namespace, live out is still in ssa names and carries
+ * junk names past SSA_def_count that we have to skip */
+inline bool ToLRID(Variable name, bool ssa_names, LRID* lrid)
+{
+  if(ssa_names)
+  {
+    if(name >= SSA_def_count) return false;
+    *lrid = Mapping::SSAName2OrigLRID(name);
+  }
+  else
+  {
+    *lrid = name;
+  }
+  return *lrid < num_lrs;
+}
+
+void BuildMatrix(Arena arena, Liveness_Info* sets, bool ssa_names,
+                 Word** bits)
+{
+  *bits = (Word*)Arena_GetMemClear(arena,
+    sizeof(Word) * words_per_block * (block_count+1));
+
+  Block* b;
+  ForAllBlocks(b)
+  {
+    Liveness_Info info = sets[bid(b)];
+    Word* row = *bits + bid(b) * words_per_block;
+    for(Unsigned_Int i = 0; i < info.size; i++)
+    {
+      LRID lrid;
+      if(ToLRID(info.names[i], ssa_names, &lrid))
+        row[lrid / WORD_BITS] |= (Word)1 << (lrid % WORD_BITS);
+    }
+  }
+}
+
+void BuildLists(Arena arena, Liveness_Info* sets, bool ssa_names,
+                LRID*** lists, Unsigned_Int** sizes)
+{
+  *lists = (LRID**)
+    Arena_GetMemClear(arena, sizeof(LRID*) * (block_count+1));
+  *sizes = (Unsigned_Int*)
+    Arena_GetMemClear(arena, sizeof(Unsigned_Int) * (block_count+1));
+
+  Block* b;
+  ForAllBlocks(b)
+  {
+    Liveness_Info info = sets[bid(b)];
+    LRID* list = (LRID*)
+      Arena_GetMem(arena, sizeof(LRID) * (info.size > 0 ? info.size : 1));
+    Unsigned_Int n = 0;
+    for(Unsigned_Int i = 0; i < info.size; i++)
+      if(ToLRID(info.names[i], ssa_names, &list[n])) n++;
+    std::sort(list, list + n);
+    n = std::unique(list, list + n) - list;
+    (*lists)[bid(b)] = list;
+    (*sizes)[bid(b)] = n;
+  }
+}
+
+inline bool Member(Word* bits, LRID** lists, Unsigned_Int* sizes,
+                   LRID lrid, Block* blk)
+{
+  if(lrid >= num_lrs) return false;
+  if(bits != NULL)
+  {
+    Word* row = bits + bid(blk) * words_per_block;
+    return (row[lrid / WORD_BITS] >> (lrid % WORD_BITS)) & 1;
+  }
+  assert(lists != NULL);
+  LRID* list = lists[bid(blk)];
+  return std::binary_search(list, list + sizes[bid(blk)], lrid);
+}
+}
+
+/*--------------------BEGIN IMPLEMENTATION---------------------*/
+namespace Liveness {
+
+/*
+ *============================
+ * Liveness::Build()
+ *============================
+ * builds the index from SSA_live_in and SSA_live_out. must be called
+ * after the live in sets have been converted to the live range
+ * namespace and while the ssa name to live range map is still valid.
+ ***/
+void Build(Arena arena, Unsigned_Int lr_count)
+{
+  num_lrs = lr_count;
+  words_per_block = (lr_count + WORD_BITS - 1) / WORD_BITS;
+  live_in_bits = live_out_bits = NULL;
+  live_in_list = live_out_list = NULL;
+  live_in_size = live_out_size = NULL;
+
+  size_t matrix_bytes =
+    sizeof(Word) * (size_t)words_per_block * (block_count+1);
+  if(matrix_bytes <= MAX_MATRIX_BYTES)
+  {
+    BuildMatrix(arena, SSA_live_in, false, &live_in_bits);
+    BuildMatrix(arena, SSA_live_out, true, &live_out_bits);
+  }
+  else
+  {
+    BuildLists(arena, SSA_live_in, false, &live_in_list, &live_in_size);
+    BuildLists(arena, SSA_live_out, true, &live_out_list, &live_out_size);
+  }
+  debug("liveness index: %d lrs in %d blocks (%s)", lr_count, block_count,
+        live_in_bits != NULL ? "matrix" : "sorted lists");
+}
+
+bool LiveIn(LRID orig_lrid, Block* blk)
+{
+  return Member(live_in_bits, live_in_list, live_in_size, orig_lrid, blk);
+}
+
+bool LiveOut(LRID orig_lrid, Block* blk)
+{
+  return Member(live_out_bits, live_out_list, live_out_size, orig_lrid,blk);
+}
+
+}//end Liveness namespace
+
@@ -0,0 +1,20 @@
+/* constant time live in and live out membership tests in the live
+ * range namespace. the SSA liveness sets are plain arrays of names, so
+ * asking whether one live range is live into a block means a linear
+ * scan. this index is built once and answers the question directly.
+ */
+
+#ifndef __GUARD_LIVENESS_H
+#define __GUARD_LIVENESS_H
+
+#include <Shared.h>
+#include "types.h"
+
+namespace Liveness {
+  void Build(Arena arena, Unsigned_Int lr_count);
+  bool LiveIn(LRID orig_lrid, Block* blk);
+  bool LiveOut(LRID orig_lrid, Block* blk);
+}
+
+#endif
+
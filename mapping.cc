@@ -38,9 +38,11 @@ void Mapping::CreateLiveRangeNameMap(Arena arena)
   for(i = 0; i < SSA_def_count; i++)
     ssa_name_to_lrid[i] = NO_LRID;
   
+  //point every name at its root so each lookup below is one load
+  UFSet_Flatten(uf_sets);
   for(i = 1; i < SSA_def_count; i++)
   {
-    setid = Find_Set(i)->id;
+    setid = Find_Set(i);
     //debug("name: %d setid: %d lrid: %d", i, setid, ssa_name_to_lrid[setid]);
     if(ssa_name_to_lrid[setid] != NO_LRID)
     {
@@ -0,0 +1,129 @@
+/* operands.cc
+ *
+ * a pre-decoded table of the register operands in each block, built
+ * once the live range names are known.
+ */
+
+/*-----------------------MODULE INCLUDES-----------------------*/
+#include <SSA.h>
+#include "operands.h"
+#include "mapping.h"
+
+/*------------------MODULE LOCAL DEFINITIONS-------------------*/
+namespace {
+using Operands::Operand;
+
+Arena operand_arena = NULL; /* holds the table until Release() */
+Operand* operands = NULL;   /* all operands in block order */
+Unsigned_Int* block_start = NULL; /* first operand of each block */
+Unsigned_Int* block_end = NULL;   /* one past the last operand */
+
+inline void Record(Operand* o, Unsigned_Int inst, Unsigned_Int op,
+                   Variable name, Operands::Kind kind)
+{
+  o->inst = inst;
+  o->op = op;
+  o->name = name;
+  o->kind = kind;
+  o->lrid = (kind == Operands::CALL_OPERAND) ?
+    NO_LRID : Mapping::SSAName2OrigLRID(name);
+}
+}
+
+/*--------------------BEGIN IMPLEMENTATION---------------------*/
+namespace Operands {
+
+/*
+ *============================
+ * Operands::Build()
+ *============================
+ * decodes every block into the operand table. must be called again
+ * whenever the live range name map changes
+ ***/
+void Build()
+{
+  Release();
+  operand_arena = Arena_Create();
+
+  //count first so the table is one contiguous array
+  Block* b;
+  Inst* inst;
+  Operation** op;
+  Variable* reg;
+  Unsigned_Int count = 0;
+  ForAllBlocks(b)
+  {
+    Block_ForAllInsts(inst, b)
+    {
+      Inst_ForAllOperations(op, inst)
+      {
+        Operation_ForAllUses(reg, *op) count++;
+        Operation_ForAllDefs(reg, *op) count++;
+        if(opcode_specs[(*op)->opcode].details & CALL) count++;
+      }
+    }
+  }
+
+  operands = (Operand*)
+    Arena_GetMem(operand_arena, sizeof(Operand) * (count+1));
+  block_start = (Unsigned_Int*)
+    Arena_GetMemClear(operand_arena, sizeof(Unsigned_Int)*(block_count+1));
+  block_end = (Unsigned_Int*)
+    Arena_GetMemClear(operand_arena, sizeof(Unsigned_Int)*(block_count+1));
+
+  Unsigned_Int pos = 0;
+  ForAllBlocks(b)
+  {
+    block_start[bid(b)] = pos;
+    Unsigned_Int inst_idx = 0;
+    Unsigned_Int op_idx = 0;
+    Block_ForAllInsts(inst, b)
+    {
+      Inst_ForAllOperations(op, inst)
+      {
+        Operation_ForAllUses(reg, *op)
+          Record(&operands[pos++], inst_idx, op_idx, *reg, USE_OPERAND);
+        Operation_ForAllDefs(reg, *op)
+          Record(&operands[pos++], inst_idx, op_idx, *reg, DEF_OPERAND);
+        if(opcode_specs[(*op)->opcode].details & CALL)
+          Record(&operands[pos++], inst_idx, op_idx, 0, CALL_OPERAND);
+        op_idx++;
+      }
+      inst_idx++;
+    }
+    block_end[bid(b)] = pos;
+  }
+  assert(pos == count);
+  debug("operand table: %d operands in %d blocks", count, block_count);
+}
+
+/*
+ *============================
+ * Operands::Release()
+ *============================
+ * frees the table once the passes reading it are done
+ ***/
+void Release()
+{
+  if(operand_arena == NULL) return;
+  Arena_Destroy(operand_arena);
+  operand_arena = NULL;
+  operands = NULL;
+  block_start = NULL;
+  block_end = NULL;
+}
+
+const Operand* Begin(Block* blk)
+{
+  assert(operands != NULL);
+  return operands + block_start[bid(blk)];
+}
+
+const Operand* End(Block* blk)
+{
+  assert(operands != NULL);
+  return operands + block_end[bid(blk)];
+}
+
+}//end Operands namespace
+
@@ -0,0 +1,51 @@
+/* a pre-decoded table of the register operands in each block. the
+ * passes that only need to know which live ranges an instruction
+ * uses and defines scan these arrays instead of walking the Inst and
+ * Operation lists and mapping every name again.
+ */
+
+#ifndef __GUARD_OPERANDS_H
+#define __GUARD_OPERANDS_H
+
+#include <Shared.h>
+#include "types.h"
+#include "debug.h"
+
+namespace Operands {
+  enum Kind {USE_OPERAND, DEF_OPERAND, CALL_OPERAND};
+
+  /* operands are stored in block order. within an operation the uses
+   * come before the defs, and an operation that is a call ends with a
+   * CALL_OPERAND entry that carries no name */
+  struct Operand
+  {
+    Unsigned_Int inst;   /* index of the instruction in the block */
+    Unsigned_Int op;     /* index of the operation in the block */
+    LRID lrid;           /* original live range of the name */
+    Variable name;       /* ssa name */
+    unsigned char kind;  /* a Kind */
+  };
+
+  void Build();
+  void Release();
+  const Operand* Begin(Block* blk);
+  const Operand* End(Block* blk);
+
+  /* the operands of the instruction or operation ending just before
+   * +last+ start at the returned position */
+  inline const Operand* InstStart(const Operand* first, const Operand* last)
+  {
+    const Operand* p = last - 1;
+    while(p != first && (p-1)->inst == (last-1)->inst) p--;
+    return p;
+  }
+  inline const Operand* OpEnd(const Operand* p, const Operand* last)
+  {
+    const Operand* q = p;
+    while(q != last && q->op == p->op) q++;
+    return q;
+  }
+}
+
+#endif
+
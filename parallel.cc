@@ -0,0 +1,100 @@
+/* parallel.cc
+ *
+ * a small fork/join helper over pthreads for the per live range
+ * analyses.
+ */
+
+/*-----------------------MODULE INCLUDES-----------------------*/
+#include <pthread.h>
+#include <vector>
+#include "parallel.h"
+#include "params.h"
+#include "debug.h"
+
+/*------------------MODULE LOCAL DEFINITIONS-------------------*/
+namespace {
+/* below this many items per worker a thread costs more than it saves */
+const Unsigned_Int MIN_ITEMS_PER_WORKER = 64;
+
+struct Chunk
+{
+  Parallel::Work work;
+  void* arg;
+  Unsigned_Int lo;
+  Unsigned_Int hi;
+  Unsigned_Int worker;
+};
+
+void* RunChunk(void* p)
+{
+  Chunk* c = static_cast<Chunk*>(p);
+  c->work(c->arg, c->lo, c->hi, c->worker);
+  return NULL;
+}
+}
+
+/*--------------------BEGIN IMPLEMENTATION---------------------*/
+namespace Parallel {
+
+/*
+ *============================
+ * Parallel::NumWorkers()
+ *============================
+ * number of workers ForRange() will use for +n+ items. callers that
+ * need per worker scratch space size it with this
+ ***/
+Unsigned_Int NumWorkers(Unsigned_Int n)
+{
+  Unsigned_Int threads = Params::Algorithm::num_threads > 1 ?
+    Params::Algorithm::num_threads : 1;
+  Unsigned_Int most = n / MIN_ITEMS_PER_WORKER;
+  if(most < threads) threads = most;
+  return threads > 0 ? threads : 1;
+}
+
+/*
+ *============================
+ * Parallel::ForRange()
+ *============================
+ * calls +work+ on [0,n) split into NumWorkers(n) contiguous chunks and
+ * returns once all of them are done. the calling thread runs the
+ * first chunk itself
+ ***/
+void ForRange(Unsigned_Int n, Work work, void* arg)
+{
+  Unsigned_Int workers = NumWorkers(n);
+  if(workers == 1)
+  {
+    work(arg, 0, n, 0);
+    return;
+  }
+
+  std::vector<Chunk> chunks(workers);
+  std::vector<pthread_t> threads(workers);
+  std::vector<bool> started(workers, false);
+  for(Unsigned_Int w = 0; w < workers; w++)
+  {
+    chunks[w].work = work;
+    chunks[w].arg = arg;
+    chunks[w].lo = (Unsigned_Int)((unsigned long long)n * w / workers);
+    chunks[w].hi = (Unsigned_Int)((unsigned long long)n * (w+1) / workers);
+    chunks[w].worker = w;
+  }
+
+  //if a thread can not be created its chunk just runs here
+  for(Unsigned_Int w = 1; w < workers; w++)
+  {
+    started[w] =
+      (pthread_create(&threads[w], NULL, RunChunk, &chunks[w]) == 0);
+  }
+  RunChunk(&chunks[0]);
+  for(Unsigned_Int w = 1; w < workers; w++)
+  {
+    if(started[w]) pthread_join(threads[w], NULL);
+    else           RunChunk(&chunks[w]);
+  }
+  debug("ran %d items on %d workers", n, workers);
+}
+
+}//end Parallel namespace
+
@@ -0,0 +1,22 @@
+/* runs independent per item work on a few threads. the items are cut
+ * into contiguous chunks, one per worker, so the work a given item
+ * sees does not depend on the thread timing.
+ */
+
+#ifndef __GUARD_PARALLEL_H
+#define __GUARD_PARALLEL_H
+
+#include <Shared.h>
+
+namespace Parallel {
+  /* called once per worker with the half open range [lo,hi) of items
+   * it owns. +worker+ is in [0, NumWorkers(n)) */
+  typedef void (*Work)(void* arg, Unsigned_Int lo, Unsigned_Int hi,
+                       Unsigned_Int worker);
+
+  Unsigned_Int NumWorkers(Unsigned_Int n);
+  void ForRange(Unsigned_Int n, Work work, void* arg);
+}
+
+#endif
+
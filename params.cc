@@ -20,6 +20,7 @@ float load_save_weight = 1.0;
 float store_save_weight = 1.0;
 float move_cost_weight = 1.0;
 bool  double_takes_two_regs = true;
+int   num_callee_saved = 0;
 }
 
 /* algorithm parameters */
@@ -38,6 +39,11 @@ bool  allocate_all_unconstrained = false;
 bool  enhanced_register_promotion = false;
 bool  prefer_clean_locals = false;
 int   split_limit = 0;
+bool  coalesce_copies = false;
+int   linear_scan_blocks = 50000;
+int   deadline_msecs = 0;
+int   num_threads = 1;
+int   split_candidates = 1;
 
 /* default heuristics */
 ColorChoice color_choice = CHOOSE_FIRST_COLOR;
@@ -51,6 +57,9 @@ PriorityFunction priority_function = CLASSIC;
 namespace Program {
 bool force_minimum_register_count = false;
 bool dump_params_only = false;
+char* result_cache_dir = NULL;
+int result_cache_mb = 64;
+bool lean_output = false;
 }
 
 }
@@ -17,6 +17,7 @@ namespace Params {
     extern float store_save_weight;
     extern float move_cost_weight;
     extern bool  double_takes_two_regs;
+    extern int   num_callee_saved;
   }
   namespace Algorithm {
     extern int bb_max_insts;
@@ -33,6 +34,11 @@ namespace Params {
     extern bool  enhanced_register_promotion;
     extern bool  prefer_clean_locals;
     extern int   split_limit;
+    extern bool  coalesce_copies;
+    extern int   linear_scan_blocks;
+    extern int   deadline_msecs;
+    extern int   num_threads;
+    extern int   split_candidates;
 
     using namespace Chow::Heuristics;
     extern WhenToSplit when_to_split;
@@ -44,6 +50,9 @@ namespace Params {
   namespace Program {
     extern bool force_minimum_register_count;
     extern bool dump_params_only;
+    extern char* result_cache_dir;
+    extern int result_cache_mb;
+    extern bool lean_output;
   }
 }
 
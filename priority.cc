@@ -11,6 +11,8 @@
 #include "cfg_tools.h" 
 #include "params.h"
 #include "shared_globals.h" 
+#include "color.h"
+#include "rc.h"
 
 /*------------------MODULE LOCAL DECLARATIONS------------------*/
 namespace {
@@ -20,7 +22,8 @@ namespace {
     bool square_len,
     bool normalize
   );
-  Priority LiveUnit_ComputePriority(LiveRange* lr, LiveUnit* lu);
+  void LiveUnit_ComputeTerms(LiveRange* lr, LiveUnit* lu, 
+                             double* benefit, double* call_cost);
   bool LiveUnit_CanMoveLoad(LiveRange* lr, LiveUnit* lu);
   int LiveUnit_LoadLoopDepth(LiveRange*  lr, LiveUnit* lu);
 
@@ -57,6 +60,22 @@ Priority GnuSquareNormal(LiveRange* lr)
   return BasePriority(lr, true, true, true);
 }
 
+/*
+ *=======================================
+ * UnitTerms()
+ *=======================================
+ * computes the priority contribution of one live unit, split into the
+ * part that always applies and the cost of saving the value around
+ * calls, which only applies when no callee saved register is left.
+ * the live range caches these per unit and keeps their sums
+ *
+ ***/
+void UnitTerms(LiveRange* lr, LiveUnit* lu, 
+               double* benefit, double* call_cost)
+{
+  LiveUnit_ComputeTerms(lr, lu, benefit, call_cost);
+}
+
 }}//end Chow::PriorityFuns namespace
 
 /*-------------------BEGIN LOCAL DEFINITIONS-------------------*/
@@ -75,14 +94,17 @@ Priority BasePriority(
   bool normalize
 )
 {
-  Priority pr = 0.0;
-  Unsigned_Int clu = 0; //count of live units
-  for(LiveRange::iterator luIT = lr->begin(), luE = lr->end(); 
-      luIT != luE; ++luIT)
-  {
-    pr += LiveUnit_ComputePriority(lr, *luIT);
-    clu++;
-  }
+  //the unit terms are cached in the live range so the priority is
+  //just a function of their sums
+  Unsigned_Int clu = lr->unit_count; //count of live units
+
+  //if no callee saved register is left for this live range then it
+  //will have to be saved and restored around any call it crosses
+  bool caller_saved = 
+    RegisterClass::NumCalleeSaved(lr->rc) > 0 &&
+    !Coloring::IsCalleeSavedColorAvailable(lr);
+  Priority pr = lr->unit_benefit_sum;
+  if(caller_saved) pr -= lr->unit_call_cost_sum;
 
   if(use_log) pr = log2(pr);
   if(square_len) clu = clu*clu;
@@ -93,8 +115,10 @@ Priority BasePriority(
 
 /*
  *=======================================
- * LiveUnit_ComputePriority()
+ * LiveUnit_ComputeTerms()
  *=======================================
+ * the call cost is kept apart from the rest of the unit priority
+ * since it depends on the registers left for the whole live range
  *
  ***/
 inline bool need_store(LiveUnit* lu){
@@ -103,24 +127,27 @@ inline bool need_store(LiveUnit* lu){
   }
   return lu->need_store;
 }
-Priority LiveUnit_ComputePriority(LiveRange* lr, LiveUnit* lu)
+void LiveUnit_ComputeTerms(LiveRange* lr, LiveUnit* lu, 
+                           double* benefit, double* call_cost)
 {
   using Params::Machine::load_save_weight;
   using Params::Machine::store_save_weight;
   using Params::Machine::move_cost_weight;
   using Params::Algorithm::loop_depth_weight;
 
-  Priority unitPrio = 
-      load_save_weight  * lu->uses 
+  double depth_weight = 
+    pow(loop_depth_weight, Globals::depths[bid(lu->block)]);
+  *benefit = 
+    ( load_save_weight  * lu->uses 
     + store_save_weight * lu->defs 
-    - move_cost_weight  * need_store(lu);
-  unitPrio *= pow(loop_depth_weight, Globals::depths[bid(lu->block)]);
+    - move_cost_weight  * need_store(lu)) * depth_weight;
+  //save and restore around each call
+  *call_cost = 2 * move_cost_weight * lu->calls * depth_weight;
 
   //treat load loop cost separte in case we can move it up from a loop
   int loadLoopDepth = LiveUnit_LoadLoopDepth(lr, lu);
-  unitPrio -=   (move_cost_weight * lu->need_load)
-                * pow(loop_depth_weight, loadLoopDepth);
-  return unitPrio;
+  *benefit -=   (move_cost_weight * lu->need_load)
+              * pow(loop_depth_weight, loadLoopDepth);
 }
 
 
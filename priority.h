@@ -19,6 +19,9 @@ namespace PriorityFuns
   Priority SquareNormal(LiveRange* lr);
   Priority Gnu(LiveRange* lr);
   Priority GnuSquareNormal(LiveRange* lr);
+
+  void UnitTerms(LiveRange* lr, LiveUnit* lu, 
+                 double* benefit, double* call_cost);
 }
 }
 
@@ -24,6 +24,7 @@ namespace {
 
 /* local variables */
 int* mRc_CReg;
+int* mRc_CCalleeSaved;
 Boolean fEnableMultipleClasses = FALSE;
 VectorSet* mRc_VsTmp; 
 RegisterClass::ReservedRegsInfo* mRc_ReservedRegs;
@@ -144,6 +145,20 @@ void Init(Arena arena,
     }
     mRc_VsTmp[rc] = VectorSet_Create(arena, mRc_CReg[rc]);
   }
+
+  //split the allocatable registers of each class into caller saved
+  //and callee saved. the callee saved registers are the last colors
+  //of the class
+  mRc_CCalleeSaved = (int*)
+    Arena_GetMemClear(arena, sizeof(int) * cRegisterClass);
+  for(unsigned int i = 0; i < all_classes.size(); i++)
+  {
+    RC rc  = all_classes[i];
+    int cCalleeSaved = Params::Machine::num_callee_saved;
+    if(cCalleeSaved > mRc_CReg[rc]) cCalleeSaved = mRc_CReg[rc];
+    if(cCalleeSaved < 0) cCalleeSaved = 0;
+    mRc_CCalleeSaved[rc] = cCalleeSaved;
+  }
 }
 
 void InitRegWidths()
@@ -272,6 +287,31 @@ int RegWidth(Def_Type dt)
   return mDefType_RegWidth[dt];
 }
 
+/*
+ *========================
+ * NumCalleeSaved()
+ *========================
+ * Returns the number of callee saved registers in the class. When
+ * this is zero calls are not taken into account during allocation.
+ */
+int NumCalleeSaved(RC rc)
+{
+  return mRc_CCalleeSaved[rc];
+}
+
+/*
+ *========================
+ * IsCalleeSaved()
+ *========================
+ * Returns true if the color maps to a callee saved register. Values
+ * kept in any other register must be saved and restored around a
+ * call.
+ */
+bool IsCalleeSaved(RC rc, Color c)
+{
+  return (int)c >= mRc_CReg[rc] - mRc_CCalleeSaved[rc];
+}
+
 }//end RegisterClass namespace
 
 /*-------------------BEGIN LOCAL DEFINITIONS-------------------*/
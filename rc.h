@@ -40,6 +40,8 @@ namespace RegisterClass {
   int FirstRegister(RegisterClass::RC);
   Color ColorForMachineReg(RC rc, Register r);
   int RegWidth(Def_Type dt);
+  int NumCalleeSaved(RC);
+  bool IsCalleeSaved(RC, Color);
 }
 
 #endif
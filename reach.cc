@@ -9,6 +9,7 @@
 /*------------------MODULE LOCAL DECLARATIONS------------------*/
 namespace {
 VectorSet* mBlk_ReachSet = NULL;
+Arena reach_arena = NULL; /* holds the reach sets until Release() */
 
 void AllocateReachMap(Arena);
 }
@@ -20,10 +21,14 @@ namespace Reach {
  *============================
  * Reach::ComputeReachability()
  *============================
- *
+ * computes the reach sets in an arena of their own so they can be
+ * dropped with Release() once the last consumer is done
  ***/
-void ComputeReachability(Arena arena)
+void ComputeReachability()
 {
+  Release();
+  reach_arena = Arena_Create();
+  Arena arena = reach_arena;
   AllocateReachMap(arena);
   std::queue<Block*> worklist;
   Block* blk;
@@ -70,9 +75,25 @@ void ComputeReachability(Arena arena)
  ***/
 VectorSet ReachableBlocks(Block* blk)
 {
+  assert(mBlk_ReachSet != NULL);
   return mBlk_ReachSet[bid(blk)];
 }
 
+/*
+ *============================
+ * Reach::Release()
+ *============================
+ * frees the reach sets. ReachableBlocks() may not be called again
+ * until the reachability is recomputed
+ ***/
+void Release()
+{
+  if(reach_arena == NULL) return;
+  Arena_Destroy(reach_arena);
+  reach_arena = NULL;
+  mBlk_ReachSet = NULL;
+}
+
 }//end Reach namespace
 
 /*-------------------BEGIN LOCAL DEFINITIONS-------------------*/
@@ -81,7 +102,7 @@ namespace {
 void AllocateReachMap(Arena arena)
 {
   mBlk_ReachSet = (VectorSet*)
-    Arena_GetMemClear(arena, sizeof(VectorSet)* block_count+1);
+    Arena_GetMemClear(arena, sizeof(VectorSet) * (block_count+1));
 
   for(unsigned int i = 1; i < block_count+1; i++)
     mBlk_ReachSet[i] = VectorSet_Create(arena, block_count+1);
@@ -11,8 +11,9 @@
 
 
 namespace Reach {
-  void ComputeReachability(Arena);
+  void ComputeReachability();
   VectorSet ReachableBlocks(Block* blk);
+  void Release();
 }
 
 #endif
@@ -46,7 +46,7 @@ namespace Remat{
 using std::vector;
 using std::pair;
 vector<LatticeElem> tags;
-UFSet** remat_sets;
+UFSet* remat_sets;
 
 /*
  *=============================
@@ -220,7 +220,7 @@ void SplitRematerializableLiveRanges()
     for(LiveRange::iterator i = lr->begin(); i != lr->end(); i++)
     {
       LiveUnit* lu = *i;
-      unsigned int setid = (Find_Set(lu->orig_name, remat_sets))->id;
+      unsigned int setid = Find_Set(lu->orig_name, remat_sets);
       debug("LiveUnit: %s(%d) is setid %d", bname(lu->block), 
              bid(lu->block), setid);
       lu_map[setid].push_back(lu);
@@ -237,7 +237,6 @@ void SplitRematerializableLiveRanges()
     {
       //create a new live range
       LiveRange* lr_new = lr->Mitosis();
-      live_ranges.push_back(lr_new);
       new_lrs.push_back(lr_new);
 
       //check if it is rematerializable
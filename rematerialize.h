@@ -25,7 +25,7 @@ typedef std::vector<std::pair<Variable,Variable> > SplitList;
 
 /*-------------------------VARIABLES---------------------------*/
 extern std::vector<LatticeElem> tags;
-extern UFSet** remat_sets;
+extern UFSet* remat_sets;
 
 /*-------------------------FUNCTIONS---------------------------*/
 void ComputeTags();
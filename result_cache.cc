@@ -0,0 +1,315 @@
+/* result_cache.cc
+ *
+ * on disk cache of allocation results. each entry is one file named
+ * by the key holding a header, the allocated iloc and the stats dump.
+ * entries are written under a temporary name and renamed into place so
+ * parallel jobs sharing the directory never read half an entry. the
+ * directory is kept under a size limit by removing the least recently
+ * used entries, a hit touches its entry to mark the use.
+ */
+
+/*-----------------------MODULE INCLUDES-----------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <dirent.h>
+#include <unistd.h>
+#include <utime.h>
+#include <sys/stat.h>
+#include "result_cache.h"
+#include "params.h"
+#include "hash.h"
+#include "debug.h"
+
+/*------------------MODULE LOCAL DEFINITIONS-------------------*/
+namespace {
+const char MAGIC[8] = {'C','H','O','W','R','E','S','1'};
+const char* SUFFIX = ".chow";
+
+/* identifies the build so a rebuilt allocator never replays results
+ * of an older one. the makefile recompiles this file whenever any
+ * other object changes */
+#ifndef CHOW_BUILD
+#define CHOW_BUILD __DATE__ " " __TIME__
+#endif
+const char BUILD[] = CHOW_BUILD;
+
+struct Header
+{
+  char magic[8];
+  Hash::Value key;
+  unsigned long long output_bytes;
+  unsigned long long stats_bytes;
+};
+
+/* an entry seen while enforcing the size limit */
+struct Entry
+{
+  std::string path;
+  time_t used;
+  off_t bytes;
+};
+struct UsedBefore
+{
+  bool operator()(const Entry& a, const Entry& b) const
+  {
+    return a.used < b.used;
+  }
+};
+
+bool enabled = false;
+Hash::Value key = 0;
+std::string dir;
+std::string entry_file;
+
+/* output of a miss is captured here until the run finishes */
+FILE* output_capture = NULL;
+FILE* stats_capture = NULL;
+
+/* counters for this run */
+unsigned int hits = 0;
+unsigned int misses = 0;
+unsigned int evicted = 0;
+
+bool Copy(FILE* from, FILE* to, unsigned long long bytes)
+{
+  char buf[64*1024];
+  while(bytes > 0)
+  {
+    size_t chunk = bytes < sizeof(buf) ? (size_t)bytes : sizeof(buf);
+    if(fread(buf, 1, chunk, from) != chunk) return false;
+    if(fwrite(buf, 1, chunk, to) != chunk) return false;
+    bytes -= chunk;
+  }
+  return true;
+}
+
+unsigned long long Rewind(FILE* fp)
+{
+  fflush(fp);
+  long bytes = ftell(fp);
+  rewind(fp);
+  return bytes > 0 ? (unsigned long long)bytes : 0;
+}
+
+bool IsEntryName(const char* name)
+{
+  size_t len = strlen(name);
+  size_t suffix = strlen(SUFFIX);
+  return len > suffix && name[0] != '.' &&
+         strcmp(name + len - suffix, SUFFIX) == 0;
+}
+
+void Store(unsigned long long output_bytes, unsigned long long stats_bytes)
+{
+  char pid[32];
+  sprintf(pid, ".%d", (int)getpid());
+  std::string tmp = dir + "/." + entry_file.substr(dir.size() + 1) + pid;
+  FILE* fp = fopen(tmp.c_str(), "wb");
+  if(fp == NULL) return;
+
+  Header hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, MAGIC, sizeof(MAGIC));
+  hdr.key = key;
+  hdr.output_bytes = output_bytes;
+  hdr.stats_bytes = stats_bytes;
+
+  bool ok = (fwrite(&hdr, sizeof(hdr), 1, fp) == 1);
+  rewind(output_capture);
+  ok = ok && Copy(output_capture, fp, output_bytes);
+  rewind(stats_capture);
+  ok = ok && Copy(stats_capture, fp, stats_bytes);
+  ok = (fclose(fp) == 0) && ok;
+
+  if(!ok || rename(tmp.c_str(), entry_file.c_str()) != 0)
+  {
+    debug("could not write result cache entry %s", entry_file.c_str());
+    remove(tmp.c_str());
+  }
+}
+
+/* removes the least recently used entries until the directory fits
+ * in the size limit. entries another job removes first are skipped */
+void Evict()
+{
+  DIR* dp = opendir(dir.c_str());
+  if(dp == NULL) return;
+
+  std::vector<Entry> entries;
+  unsigned long long total = 0;
+  struct dirent* de;
+  while((de = readdir(dp)) != NULL)
+  {
+    if(!IsEntryName(de->d_name)) continue;
+    Entry e;
+    e.path = dir + "/" + de->d_name;
+    struct stat st;
+    if(stat(e.path.c_str(), &st) != 0) continue;
+    e.used = st.st_mtime;
+    e.bytes = st.st_size;
+    total += st.st_size;
+    entries.push_back(e);
+  }
+  closedir(dp);
+
+  unsigned long long limit = 
+    (unsigned long long)Params::Program::result_cache_mb * 1024 * 1024;
+  std::sort(entries.begin(), entries.end(), UsedBefore());
+  for(unsigned int i = 0; i < entries.size() && total > limit; i++)
+  {
+    if(entries[i].path == entry_file) continue;
+    if(unlink(entries[i].path.c_str()) == 0) evicted++;
+    total -= entries[i].bytes;
+  }
+}
+
+void DumpStats(FILE* out)
+{
+  fprintf(out, "----------- result cache -----------------\n");
+  fprintf(out, " Hits   : %d\n", hits);
+  fprintf(out, " Misses : %d\n", misses);
+  fprintf(out, " Evicted: %d\n", evicted);
+  fprintf(out, "----------- result cache -----------------\n");
+}
+}
+
+/*--------------------BEGIN IMPLEMENTATION---------------------*/
+namespace ResultCache {
+
+/*
+ *============================
+ * ResultCache::Init()
+ *============================
+ * computes the key from the build, the input file and the dumped
+ * parameter table. the cache is only used when a directory is given and the
+ * input comes from a file, stdin can not be hashed without consuming
+ * it
+ ***/
+void Init(const char* input_file, const char* params, size_t params_len)
+{
+  enabled = false;
+  const char* cache_dir = Params::Program::result_cache_dir;
+  if(cache_dir == NULL || cache_dir[0] == '\0') return;
+  if(input_file == NULL)
+  {
+    debug("input is stdin, result cache disabled");
+    return;
+  }
+
+  key = Hash::Bytes(MAGIC, sizeof(MAGIC));
+  key = Hash::Bytes(BUILD, sizeof(BUILD) - 1, key);
+  key = Hash::Bytes(params, params_len, key);
+  if(!Hash::File(input_file, &key))
+  {
+    debug("could not read %s, result cache disabled", input_file);
+    return;
+  }
+
+  dir = cache_dir;
+  mkdir(dir.c_str(), 0777); //may already exist
+  char name[64];
+  sprintf(name, "/%016llx%s", key, SUFFIX);
+  entry_file = dir + name;
+  enabled = true;
+}
+
+/*
+ *============================
+ * ResultCache::Replay()
+ *============================
+ * on a hit writes the stored iloc to stdout and the stored stats to
+ * stderr and returns true. on a miss starts capturing the output of
+ * this run so Finish() can store it
+ ***/
+bool Replay()
+{
+  if(!enabled) return false;
+
+  FILE* fp = fopen(entry_file.c_str(), "rb");
+  if(fp != NULL)
+  {
+    Header hdr;
+    struct stat st;
+    bool ok = fread(&hdr, sizeof(hdr), 1, fp) == 1 &&
+      memcmp(hdr.magic, MAGIC, sizeof(MAGIC)) == 0 && hdr.key == key &&
+      fstat(fileno(fp), &st) == 0 &&
+      (unsigned long long)st.st_size == 
+        sizeof(hdr) + hdr.output_bytes + hdr.stats_bytes;
+    //read the whole entry before writing anything so a short read
+    //can still fall back to a miss
+    std::vector<char> output, stats;
+    if(ok)
+    {
+      output.resize(hdr.output_bytes + 1);
+      stats.resize(hdr.stats_bytes + 1);
+      ok = fread(&output[0], 1, hdr.output_bytes, fp) == hdr.output_bytes &&
+           fread(&stats[0], 1, hdr.stats_bytes, fp) == hdr.stats_bytes;
+    }
+    fclose(fp);
+    if(ok)
+    {
+      fwrite(&output[0], 1, hdr.output_bytes, stdout);
+      fwrite(&stats[0], 1, hdr.stats_bytes, stderr);
+      utime(entry_file.c_str(), NULL); //most recently used
+      hits++;
+      DumpStats(stderr);
+      return true;
+    }
+    debug("ignoring bad result cache entry %s", entry_file.c_str());
+  }
+
+  misses++;
+  output_capture = tmpfile();
+  stats_capture = tmpfile();
+  if(output_capture == NULL || stats_capture == NULL)
+  {
+    if(output_capture) fclose(output_capture);
+    if(stats_capture) fclose(stats_capture);
+    output_capture = stats_capture = NULL;
+  }
+  return false;
+}
+
+/* where the allocated iloc and the stats dump should be written */
+FILE* OutputFile()
+{
+  return output_capture != NULL ? output_capture : stdout;
+}
+
+FILE* StatsFile()
+{
+  return stats_capture != NULL ? stats_capture : stderr;
+}
+
+/*
+ *============================
+ * ResultCache::Finish()
+ *============================
+ * passes the captured output of a miss on to stdout and stderr, stores
+ * it as a new entry and trims the directory back to its size limit
+ ***/
+void Finish()
+{
+  if(!enabled) return;
+  if(output_capture != NULL)
+  {
+    unsigned long long output_bytes = Rewind(output_capture);
+    unsigned long long stats_bytes = Rewind(stats_capture);
+    Copy(output_capture, stdout, output_bytes);
+    Copy(stats_capture, stderr, stats_bytes);
+    fflush(stdout);
+
+    Store(output_bytes, stats_bytes);
+    Evict();
+    fclose(output_capture);
+    fclose(stats_capture);
+    output_capture = stats_capture = NULL;
+  }
+  DumpStats(stderr);
+}
+
+}//end ResultCache namespace
+
@@ -0,0 +1,22 @@
+/* on disk cache of whole allocation results. the allocated iloc and
+ * the stats dump of a run are stored under a hash of the input file
+ * and the parameter table, so running the allocator again on the same
+ * procedure with the same parameters just replays them.
+ */
+
+#ifndef __GUARD_RESULT_CACHE_H
+#define __GUARD_RESULT_CACHE_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+namespace ResultCache {
+  void Init(const char* input_file, const char* params, size_t params_len);
+  bool Replay();
+  FILE* OutputFile();
+  FILE* StatsFile();
+  void Finish();
+}
+
+#endif
+
@@ -8,5 +8,7 @@
 #include "shared_globals.h"
 
 unsigned int* depths;
+unsigned int* loop_heads;
 unsigned int* Globals::depths;
+unsigned int* Globals::loop_heads;
 
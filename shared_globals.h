@@ -5,8 +5,10 @@
 
 //from depths.h
 extern unsigned int* depths;
+extern unsigned int* loop_heads;
 
 namespace Globals {
   extern unsigned int* depths;
+  extern unsigned int* loop_heads;
 }
 #endif
@@ -5,6 +5,7 @@
  */
 #include <map>
 #include <string.h>
+#include <stdarg.h>
 
 #include "spill.h"
 #include "live_range.h"
@@ -49,6 +50,8 @@ namespace {
                              Register dest);
   Inst* CreateLightWeightLoad(LiveRange* lr, Register dest);
   Inst* CreateHeavyWeightLoad(LiveRange*, Register, Register);
+  Comment_Val InstComment(const char* fmt, ...);
+  Expr SourceLineRef();
 }
 
 /*--------------------MODULE IMPLEMENTATION---------------------*/
@@ -181,9 +184,7 @@ Inst* InsertStore(LiveRange* lr, Inst* around_inst, Register src,
          lr->id, src, offset);
 
   //generate a comment
-  char str[64]; 
-  sprintf(str, "STORE %d_%d", lr->orig_lrid, lr->id); 
-  Comment_Val comment = Comment_Install(str);
+  Comment_Val comment = InstComment("STORE %d_%d", lr->orig_lrid, lr->id);
 
   //get opcode and alignment for live range
   Opcode_Names opcode = lr->StoreOpcode();
@@ -214,10 +215,8 @@ void InsertCopy(const LiveRange* lrSrc, const LiveRange* lrDest,
                  InstInsertLocation loc)
 {
   //generate a comment
-  char str[64]; char lrname[32]; char lrname2[32]; 
-  LRName(lrSrc, lrname); LRName(lrDest, lrname2);
-  sprintf(str, "RR COPY for %s --> %s", lrname, lrname2);
-  Comment_Val comment = Comment_Install(str);
+  Comment_Val comment = InstComment("RR COPY for %d_%d --> %d_%d", 
+    lrSrc->orig_lrid, lrSrc->id, lrDest->orig_lrid, lrDest->id);
 
   //get opcode and alignment for live range
   Opcode_Names opcode = lrSrc->CopyOpcode();
@@ -255,9 +254,7 @@ Inst* CreateHeavyWeightLoad(LiveRange* lr, Register dest, Register base)
          "base: %d", lr->id, dest, offset, base);
 
   //generate a comment
-  char str[64];
-  sprintf(str, "LOAD %d_%d", lr->orig_lrid, lr->id); 
-  Comment_Val comment = Comment_Install(str);
+  Comment_Val comment = InstComment("LOAD %d_%d", lr->orig_lrid, lr->id);
 
   return
     Inst_CreateLoad(opcode, tag, alignment, comment, offset, base, dest);
@@ -278,14 +275,13 @@ Inst* CreateLightWeightLoad(LiveRange* lr, Register dest)
     Operation_Allocate(spill_arena, LDI_OPSIZE);
 
   //comment
-  char str[64];
-  sprintf(str, "REMATERIALIZE %d_%d", lr->orig_lrid, lr->id); 
-  Comment_Val comment = Comment_Install(str);
+  Comment_Val comment = 
+    InstComment("REMATERIALIZE %d_%d", lr->orig_lrid, lr->id);
 
   //copy operation used for rematerialization
   memcpy(ld_op, lr->remat_op, sizeof(Operation));
   ld_op->comment = comment;
-  ld_op->source_line_ref = Expr_Install_String("0");
+  ld_op->source_line_ref = SourceLineRef();
   ld_op->arguments[ld_op->defined-1] = dest;
 
   //create inst and set the load op
@@ -382,7 +378,7 @@ Inst* Inst_CreateLoad(Opcode_Names opcode,
   //fill in struct
   ld_op->opcode  = opcode;
   ld_op->comment = comment;
-  ld_op->source_line_ref = Expr_Install_String("0");
+  ld_op->source_line_ref = SourceLineRef();
   ld_op->constants = 3;
   ld_op->referenced = 4;
   ld_op->defined = 5;
@@ -427,7 +423,7 @@ Inst* Inst_CreateStore(Opcode_Names opcode,
   //fill in struct
   st_op->opcode  = opcode;
   st_op->comment = comment;
-  st_op->source_line_ref = Expr_Install_String("0");
+  st_op->source_line_ref = SourceLineRef();
   st_op->constants = 3;
   st_op->referenced = 5;
   st_op->defined = 5;
@@ -469,7 +465,7 @@ Inst* Inst_CreateCopy(Opcode_Names opcode,
   //fill in struct
   cp_op->opcode  = opcode;
   cp_op->comment = comment;
-  cp_op->source_line_ref = Expr_Install_String("0");
+  cp_op->source_line_ref = SourceLineRef();
   cp_op->constants = 0;
   cp_op->referenced = 1;
   cp_op->defined = 2;
@@ -487,5 +483,44 @@ Inst* Inst_CreateCopy(Opcode_Names opcode,
   return cp_inst;
 }
 
+/*
+ *=====================
+ * InstComment()
+ *=====================
+ * installs the printf style diagnostic comment for an inserted
+ * instruction. in lean output mode no comment is made, which keeps
+ * the comment table from growing with every spill
+ **/
+Comment_Val InstComment(const char* fmt, ...)
+{
+  if(Params::Program::lean_output) return 0;
+
+  char str[64];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(str, sizeof(str), fmt, args);
+  va_end(args);
+  return Comment_Install(str);
+}
+
+/*
+ *=====================
+ * SourceLineRef()
+ *=====================
+ * source line reference given to inserted operations. installed once
+ * instead of looked up again for every instruction
+ **/
+Expr SourceLineRef()
+{
+  static bool installed = false;
+  static Expr line_ref;
+  if(!installed)
+  {
+    line_ref = Expr_Install_String("0");
+    installed = true;
+  }
+  return line_ref;
+}
+
 }//end anonymous namespace 
 
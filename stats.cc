@@ -7,12 +7,26 @@
  */
 
 /*-----------------------MODULE INCLUDES-----------------------*/
+#include <SSA.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <unistd.h>
 #include "stats.h"
 #include "mapping.h"
+#include "params.h"
+#include "operands.h"
 
 /*------------------MODULE LOCAL DEFINITIONS-------------------*/
 namespace {
 Stats::BBStats** bb_stats = NULL;
+struct timeval deadline;       /* for the whole allocation */
+struct timeval slice_deadline; /* for the current register class */
+bool deadline_set = false;
+bool slice_expired = false;
+void AddMsecs(struct timeval*, int msecs);
+void CountCallsCrossed(Arena, Unsigned_Int);
+long CurrentRSS();
+long PeakRSS();
 }
 
 /*--------------------BEGIN IMPLEMENTATION---------------------*/
@@ -35,10 +49,9 @@ void ComputeBBStats(Arena arena, Unsigned_Int variable_count)
 {
   using Mapping::SSAName2OrigLRID;
 
+  using Operands::Operand;
+
   Block* b;
-  Inst* inst;
-  Operation** op;
-  Variable* reg;
   BBStats* bstats;
 
 
@@ -55,26 +68,26 @@ void ComputeBBStats(Arena arena, Unsigned_Int variable_count)
   ForAllBlocks(b)
   {
     bstats = bb_stats[bid(b)];
-    Block_ForAllInsts(inst, b)
+    const Operand* end = Operands::End(b);
+    for(const Operand* o = Operands::Begin(b); o != end; o++)
     {
-      Inst_ForAllOperations(op, inst)
+      lrid = o->lrid;
+      if(o->kind == Operands::USE_OPERAND)
       {
-        Operation_ForAllUses(reg, *op)
-        {
-          lrid = SSAName2OrigLRID(*reg);
-          bstats[lrid].uses++;
-        }
-
-        Operation_ForAllDefs(reg, *op)
-        {
-          lrid = SSAName2OrigLRID(*reg);
-          bstats[lrid].defs++;
-          if(bstats[lrid].uses == 0)
-            bstats[lrid].start_with_def = TRUE;
-        }
-      } 
+        bstats[lrid].uses++;
+      }
+      else if(o->kind == Operands::DEF_OPERAND)
+      {
+        bstats[lrid].defs++;
+        if(bstats[lrid].uses == 0)
+          bstats[lrid].start_with_def = TRUE;
+      }
     }
   }
+
+  //only needed when modeling the cost of caller saved registers
+  if(Params::Machine::num_callee_saved > 0)
+    CountCallsCrossed(arena, variable_count);
 }
 
 /*
@@ -85,50 +98,85 @@ void ComputeBBStats(Arena arena, Unsigned_Int variable_count)
  ***/
 BBStats GetStatsForBlock(Block* blk, LRID lrid)
 {
+  assert(bb_stats != NULL);
   return bb_stats[bid(blk)][lrid];
 }
 
+/*
+ *==========================
+ * Stats::ReleaseBBStats()
+ *==========================
+ * Forget the block statistics once the arena they were computed in
+ * is about to be destroyed. The live units keep their own copy.
+ ***/
+void ReleaseBBStats()
+{
+  bb_stats = NULL;
+}
+
 /*
  *======================
  * DumpAllocationStats()
  *======================
  *
  ***/
-void DumpAllocationStats()
+void DumpAllocationStats(FILE* out)
 {
   //note: +/- 1 colored/spill count is for frame pointer live range
-  fprintf(stderr, "***** ALLOCATION STATISTICS *****\n");
-  fprintf(stderr, " Inital  LiveRange Count: %d\n",
+  fprintf(out, "***** ALLOCATION STATISTICS *****\n");
+  fprintf(out, " Allocator Tier: %s\n", 
+                  chowstats.fLinearScanTier ? "linear scan" : "chow");
+  fprintf(out, " Inital  LiveRange Count: %d\n",
                                            chowstats.clrInitial);
-  fprintf(stderr, " Final   LiveRange Count: %d\n",
+  fprintf(out, " Final   LiveRange Count: %d\n",
                                            chowstats.clrFinal);
-  fprintf(stderr, " Remat   LiveRange Count: %d\n",
+  fprintf(out, " Remat   LiveRange Count: %d\n",
                                            chowstats.clrRemat);
-  fprintf(stderr, " Colored LiveRange Count: %d\n",
+  fprintf(out, " Colored LiveRange Count: %d\n",
                                            chowstats.clrColored+1);
-  fprintf(stderr, " Spilled LiveRange Count: %d\n", 
+  fprintf(out, " Spilled LiveRange Count: %d\n", 
                                            chowstats.cSpills);
-  fprintf(stderr, " Zero Occurrence  Count: %d\n", 
+  fprintf(out, " Zero Occurrence  Count: %d\n", 
                                            chowstats.cZeroOccurrence);
-  fprintf(stderr, " Number of Splits: %d\n", chowstats.cSplits);
-  fprintf(stderr, " Inserted Copies : %d\n", chowstats.cInsertedCopies);
-  fprintf(stderr, " Thwarted Copies : %d\n", chowstats.cThwartedCopies);
-  fprintf(stderr, " Found   Optimist: %d\n", chowstats.cFoundOptimist);
-  fprintf(stderr, " Spilled Optimist: %d\n", chowstats.cSpilledOptimist);
-
-  fprintf(stderr, "\n");
-  fprintf(stderr, "----------- allocation times -------------\n");
+  fprintf(out, " Number of Splits: %d\n", chowstats.cSplits);
+  fprintf(out, " Splits From Better Seed: %d\n", 
+                                           chowstats.cSplitSeedsImproved);
+  fprintf(out, " Inserted Copies : %d\n", chowstats.cInsertedCopies);
+  fprintf(out, " Thwarted Copies : %d\n", chowstats.cThwartedCopies);
+  fprintf(out, " Coalesced Copies: %d\n", chowstats.cCoalescedCopies);
+  fprintf(out, " Deadline Fired  : %s\n", 
+                  chowstats.fDeadlineFired ? "yes" : "no");
+  fprintf(out, " Degraded LiveRange Count: %d\n", chowstats.cDegraded);
+  fprintf(out, " Found   Optimist: %d\n", chowstats.cFoundOptimist);
+  fprintf(out, " Spilled Optimist: %d\n", chowstats.cSpilledOptimist);
+  fprintf(out, " Fear List Peak Bytes : %lu\n", 
+                          (unsigned long)chowstats.cFearListPeakBytes);
+  fprintf(out, " Fear List Dense Bytes: %lu\n", 
+                          (unsigned long)chowstats.cFearListDenseBytes);
+
+  fprintf(out, "\n");
+  fprintf(out, "----------- allocation times -------------\n");
   Timer::SavedTimes saved_times = section_timer.GetSavedTimes();
   for(Timer::SavedTimes::size_type i = 0; i < saved_times.size(); i++)
   {
-    fprintf(stderr, " %s: %.1f (s)\n", 
+    fprintf(out, " %s: %.1f (s)\n", 
       saved_times[i].first,saved_times[i].second);
   }
-  fprintf(stderr, "\n");
-  fprintf(stderr, " Whole Program: %s\n", program_timer.ElapsedStr());
-  fprintf(stderr, "----------- allocation times -------------\n");
+  fprintf(out, "\n");
+  fprintf(out, " Whole Program: %s\n", program_timer.ElapsedStr());
+  fprintf(out, "----------- allocation times -------------\n");
+
+  fprintf(out, "\n");
+  fprintf(out, "----------- phase memory (KB) ------------\n");
+  Timer::SavedMemory saved_memory = section_timer.GetSavedMemory();
+  for(Timer::SavedMemory::size_type i = 0; i < saved_memory.size(); i++)
+  {
+    fprintf(out, " %s: rss %ld, peak rss %ld\n", 
+      saved_times[i].first, saved_memory[i].first, saved_memory[i].second);
+  }
+  fprintf(out, "----------- phase memory (KB) ------------\n");
   
-  fprintf(stderr, "***** ALLOCATION STATISTICS *****\n");
+  fprintf(out, "***** ALLOCATION STATISTICS *****\n");
 }
 
 //thin wrapper around timer so we can turn off timings easily
@@ -141,6 +189,82 @@ void Stop()
   section_timer.Stop();
 }
 
+/*
+ *==========================
+ * Stats::StartDeadline()
+ *==========================
+ * Sets a deadline msecs milliseconds from now. A value <= 0 means
+ * there is no deadline.
+ ***/
+void StartDeadline(int msecs)
+{
+  deadline_set = (msecs > 0);
+  slice_expired = false;
+  if(!deadline_set) return;
+
+  gettimeofday(&deadline, NULL);
+  AddMsecs(&deadline, msecs);
+  slice_deadline = deadline;
+}
+
+/*
+ *==========================
+ * Stats::StartDeadlineSlice()
+ *==========================
+ * Narrows the deadline to msecs milliseconds from now until the next
+ * slice is started. The slice never runs past the deadline itself.
+ * Does nothing when there is no deadline.
+ ***/
+void StartDeadlineSlice(int msecs)
+{
+  if(!deadline_set) return;
+
+  slice_expired = false;
+  gettimeofday(&slice_deadline, NULL);
+  AddMsecs(&slice_deadline, msecs);
+  if(timercmp(&deadline, &slice_deadline, <)) slice_deadline = deadline;
+}
+
+/*
+ *==========================
+ * Stats::DeadlineMsecsLeft()
+ *==========================
+ * Returns the milliseconds left until the deadline, or -1 if there
+ * is no deadline.
+ ***/
+int DeadlineMsecsLeft()
+{
+  if(!deadline_set) return -1;
+
+  struct timeval now, left;
+  gettimeofday(&now, NULL);
+  if(!timercmp(&now, &deadline, <)) return 0;
+  timersub(&deadline, &now, &left);
+  return left.tv_sec * 1000 + left.tv_usec / 1000;
+}
+
+/*
+ *==========================
+ * Stats::DeadlineExpired()
+ *==========================
+ * Returns true once the current slice of the deadline has passed.
+ * Records in the stats that the deadline fired.
+ ***/
+bool DeadlineExpired()
+{
+  if(!deadline_set) return false;
+  if(slice_expired) return true;
+
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  if(!timercmp(&now, &slice_deadline, <))
+  {
+    slice_expired = true;
+    chowstats.fDeadlineFired = TRUE;
+  }
+  return slice_expired;
+}
+
 
 /* Timer implemenation */
 void Timer::Start(const char* section_)
@@ -156,6 +280,7 @@ double Timer::Stop()
   time_t tend = time(NULL);
   elapsed_time = difftime(tend, tstart);
   saved_times.push_back(make_pair(section, elapsed_time));
+  saved_memory.push_back(make_pair(CurrentRSS(), PeakRSS()));
   return elapsed_time;
 }
 
@@ -173,4 +298,104 @@ const char* Timer::ElapsedStr()
 
 }
 /*------------------INTERNAL MODULE FUNCTIONS--------------------*/
+namespace {
+/*
+ *======================
+ * CountCallsCrossed()
+ *======================
+ * Walks each block backwards keeping track of the live variables to
+ * count the number of calls each variable is live across. A variable
+ * is live across a call if it is live after the call and not defined
+ * by it.
+ ***/
+void CountCallsCrossed(Arena arena, Unsigned_Int variable_count)
+{
+  using Mapping::SSAName2OrigLRID;
+  using Operands::Operand;
+
+  Block* b;
+  Unsigned_Int lrid;
+  SparseSet live = SparseSet_Create(arena, variable_count);
+  ForAllBlocks(b)
+  {
+    Stats::BBStats* bstats = bb_stats[bid(b)];
+    Liveness_Info info = SSA_live_out[bid(b)];
+    SparseSet_Clear(live);
+    for(unsigned int j = 0; j < info.size; j++)
+      SparseSet_Insert(live, SSAName2OrigLRID(info.names[j]));
+
+    //instructions in reverse, the operations of each in order
+    const Operand* first = Operands::Begin(b);
+    for(const Operand* inst_end = Operands::End(b); inst_end != first;)
+    {
+      const Operand* inst_start = Operands::InstStart(first, inst_end);
+      for(const Operand* o = inst_start; o != inst_end;)
+      {
+        const Operand* op_end = Operands::OpEnd(o, inst_end);
+        for(const Operand* d = o; d != op_end; d++)
+          if(d->kind == Operands::DEF_OPERAND) 
+            SparseSet_Delete(live, d->lrid);
+
+        if((op_end-1)->kind == Operands::CALL_OPERAND)
+        {
+          SparseSet_ForAll(lrid, live)
+            bstats[lrid].calls++;
+        }
+
+        for(const Operand* u = o; u != op_end; u++)
+          if(u->kind == Operands::USE_OPERAND) 
+            SparseSet_Insert(live, u->lrid);
+        o = op_end;
+      }
+      inst_end = inst_start;
+    }
+  }
+}
+
+/*
+ *============================
+ * CurrentRSS()
+ *============================
+ * resident set size of the process in KB, or 0 if it is unknown
+ ***/
+long CurrentRSS()
+{
+  long pages = 0;
+  FILE* statm = fopen("/proc/self/statm", "r");
+  if(statm == NULL) return 0;
+  if(fscanf(statm, "%*d %ld", &pages) != 1) pages = 0;
+  fclose(statm);
+  return pages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+/*
+ *============================
+ * PeakRSS()
+ *============================
+ * high water mark of the resident set size in KB
+ ***/
+long PeakRSS()
+{
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+  return usage.ru_maxrss;
+}
+
+/*
+ *============================
+ * AddMsecs()
+ *============================
+ * moves the time +tv+ msecs milliseconds later
+ ***/
+void AddMsecs(struct timeval* tv, int msecs)
+{
+  tv->tv_sec  += msecs / 1000;
+  tv->tv_usec += (msecs % 1000) * 1000;
+  if(tv->tv_usec >= 1000000)
+  {
+    tv->tv_sec++;
+    tv->tv_usec -= 1000000;
+  }
+}
+}
 
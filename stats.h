@@ -21,6 +21,7 @@ struct BBStats
   Unsigned_Int defs;
   Unsigned_Int uses;
   Boolean start_with_def;
+  Unsigned_Int calls; /* calls the variable is live across */
 };
 
 //statistics for allocation
@@ -33,24 +34,34 @@ struct ChowStats
   Unsigned_Int cSplits;
   Unsigned_Int cSpills;
   Unsigned_Int cZeroOccurrence;
+  Unsigned_Int cSplitSeedsImproved; /* splits not started at first seed */
   Unsigned_Int cChowStores;
   Unsigned_Int cChowLoads;
   Unsigned_Int cInsertedCopies;
   Unsigned_Int cThwartedCopies;
   Unsigned_Int cSpilledOptimist;
   Unsigned_Int cFoundOptimist;
+  Unsigned_Int cCoalescedCopies;
+  Boolean fLinearScanTier;
+  Boolean fDeadlineFired;
+  Unsigned_Int cDegraded;
+  size_t cFearListPeakBytes;
+  size_t cFearListDenseBytes; /* same sets as one bit per lr */
 };
 
 class Timer
 {
 public:
   typedef std::vector<std::pair<const char*, double> > SavedTimes;
+  /* resident set size in KB at the end of a section: current, peak */
+  typedef std::vector<std::pair<long, long> > SavedMemory;
 
 private:
   double elapsed_time;
   const char* section;
   time_t tstart;
   SavedTimes saved_times;
+  SavedMemory saved_memory;
 
 public:
   void Start(const char* = "");
@@ -58,6 +69,7 @@ public:
   const char*  ElapsedStr(); 
   inline double Elapsed() {return elapsed_time;}
   const SavedTimes GetSavedTimes(){return saved_times;}
+  const SavedMemory GetSavedMemory(){return saved_memory;}
 
 };
 
@@ -70,9 +82,14 @@ extern Timer section_timer;
 /*-------------------------FUNCTIONS---------------------------*/
 void ComputeBBStats(Arena, Unsigned_Int);
 BBStats GetStatsForBlock(Block* blk, LRID lrid);
-void DumpAllocationStats();
+void ReleaseBBStats();
+void DumpAllocationStats(FILE* out = stderr);
 void Start(const char*); //timing functions
 void Stop();  //timing functions
+void StartDeadline(int msecs);
+void StartDeadlineSlice(int msecs);
+int DeadlineMsecsLeft();
+bool DeadlineExpired();
 }
 
 #endif
@@ -33,6 +33,7 @@ struct LRcmp;
 typedef std::vector<LiveRange*> LRVec;
 typedef std::set<LiveRange*, LRcmp> LRSet;
 typedef std::list<LiveRange*> LRList;
+typedef std::set<LRID> LRIDSet; /* ordered by id like LRSet */
 
 const LRID NO_LRID = (LRID) -1; //not a valid LRID
 
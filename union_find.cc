@@ -8,7 +8,7 @@
 #include "debug.h"
 
 //globals
-UFSet** uf_sets;
+UFSet* uf_sets;
 
 //locals
 static Arena uf_arena;
@@ -27,119 +27,128 @@ void UFSets_Init(Arena arena, Unsigned_Int num_sets)
 
 /*
  *===================
- * UFSet_Init()
+ * UFSets_Release()
  *===================
- * Creates an array of UFSet structs that can be passed to Find_Set
+ * Forget the sets once the arena they live in is about to be
+ * destroyed.
  ***/
-UFSet** UFSet_Create(unsigned int num_sets)
+void UFSets_Release()
 {
-  UFSet** sets;
-  sets = (UFSet**) 
-    Arena_GetMemClear(uf_arena, sizeof(UFSet*) * num_sets);
-
-  Unsigned_Int i;
-  for(i = 0; i < num_sets; i++)
-    sets[i] = UFSet_Make(i); 
-
-  return sets;
+  uf_sets = NULL;
+  uf_arena = NULL;
 }
 
 /*
  *===================
- * UFSet_Alloc()
+ * UFSet_Create()
  *===================
- * 
+ * Creates a forest of singleton sets that can be passed to Find_Set
  ***/
-UFSet* UFSet_Alloc()
+UFSet* UFSet_Create(unsigned int num_sets)
 {
-  return (UFSet*)Arena_GetMemClear(uf_arena, sizeof(UFSet));
-}
+  UFSet* sets = (UFSet*)Arena_GetMemClear(uf_arena, sizeof(UFSet));
+  sets->size = num_sets;
+  sets->parent = (Unsigned_Int*)
+    Arena_GetMem(uf_arena, sizeof(Unsigned_Int) * (num_sets + 1));
 
+  for(Unsigned_Int i = 0; i < num_sets; i++)
+    sets->parent[i] = i;
 
-/*
- *===================
- * UFSet_Make()
- *===================
- * 
- ***/
-UFSet* UFSet_Make(Variable v)
-{
-  UFSet* set = UFSet_Alloc();
-  set->id = v;
-  set->parent = NULL;
-  set->rank = 0;
-
-  return set;
+  return sets;
 }
 
-
 /*
  *===================
  * UFSet_Find()
  *===================
- * 
+ * returns the root of the set holding +v+. uses path halving: every
+ * other node on the path is pointed at its grandparent as we go. only
+ * non roots are rewritten and always to one of their ancestors, so a
+ * racing write can at worst undo some halving and this is safe to run
+ * alongside UFSet_UnionConcurrent()
  ***/
-UFSet* UFSet_Find(UFSet* elem)
+Variable UFSet_Find(UFSet* sets, Variable v)
 {
-  UFSet* root;
-  UFSet* runner;
-
-  assert(elem != NULL);//trouble
-  for(root = elem; root->parent != NULL; root = root->parent);
-  if(elem != root)
-    for(runner = elem->parent; runner != root; 
-        elem = runner, runner = runner->parent)
-    {
-      elem->parent = root;
-    }
-
-  return root;
+  assert(v < sets->size);//trouble
+  volatile Unsigned_Int* parent = sets->parent;
+  for(;;)
+  {
+    Unsigned_Int p = parent[v];
+    if(p == v) return v;
+    Unsigned_Int gp = parent[p];
+    parent[v] = gp;
+    v = gp;
+  }
 }
 
 /*
  *===================
  * UFSet_Union()
  *===================
- * 
+ * joins the sets holding +v1+ and +v2+ and returns the root of the
+ * result
  ***/
-UFSet* UFSet_Union(UFSet* set1, UFSet* set2)
+Variable UFSet_Union(UFSet* sets, Variable v1, Variable v2)
 {
-  UFSet* s1 = UFSet_Find(set1);
-  UFSet* s2 = UFSet_Find(set2);
+  Variable s1 = UFSet_Find(sets, v1);
+  Variable s2 = UFSet_Find(sets, v2);
 
   if(s1 == s2) return s1; //noop
 
-  UFSet* top = NULL;
-  //s1 rank greater
-  if(s1->rank > s2->rank)
-  {
-    s2->parent = s1;
-    top = s1;
-  }
-  else
+  Variable top = s1 < s2 ? s1 : s2;
+  sets->parent[s1 < s2 ? s2 : s1] = top;
+
+  debug("union: %d v %d = %d", s1, s2, top);
+  return top;
+}
+
+/*
+ *==========================
+ * UFSet_UnionConcurrent()
+ *==========================
+ * UFSet_Union() for several threads working on the same sets. the
+ * larger root is linked with a compare and swap that fails if some
+ * other thread linked it first, in which case we find the roots again
+ * and retry. returns true if this call joined two different sets
+ ***/
+bool UFSet_UnionConcurrent(UFSet* sets, Variable v1, Variable v2)
+{
+  for(;;)
   {
-    //s2 greater or equal
-    s1->parent = s2;
-    top = s2;
-    if(s1->rank == s2->rank)
-    {
-      s2->rank++;
-    }
+    Variable s1 = UFSet_Find(sets, v1);
+    Variable s2 = UFSet_Find(sets, v2);
+    if(s1 == s2) return false;
+
+    Variable top = s1 < s2 ? s1 : s2;
+    Variable bottom = s1 < s2 ? s2 : s1;
+    if(__sync_bool_compare_and_swap(&sets->parent[bottom], bottom, top))
+      return true;
   }
+}
 
-  debug("union: %d v %d = %d", s1->id, s2->id, top->id);
-  return top;
+/*
+ *===================
+ * UFSet_Flatten()
+ *===================
+ * points every name straight at its root. parents never have a larger
+ * index than their children, so one pass in increasing order is
+ * enough. must not run alongside any union
+ ***/
+void UFSet_Flatten(UFSet* sets)
+{
+  Unsigned_Int* parent = sets->parent;
+  for(Unsigned_Int i = 0; i < sets->size; i++)
+    parent[i] = parent[parent[i]];
 }
 
 /*
  *===================
  * Find_Set()
  *===================
- * Returns pointer to the UFSet structure for the given variable
+ * Returns the set id (the root name) for the given variable
  **/
-UFSet* Find_Set(Variable v, UFSet** sets)
+Variable Find_Set(Variable v, UFSet* sets)
 {
-  return UFSet_Find(sets[v]);
+  return UFSet_Find(sets, v);
 }
 
-
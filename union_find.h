@@ -12,28 +12,31 @@
 #include "types.h"
 
 /* types */
+/* a forest over the names 0..size-1 in one flat array. parent[v] == v
+ * for a root. a union always links the larger root under the smaller
+ * one, so every parent index is at most its child's and the root of a
+ * set is its smallest name no matter the order of the unions */
 struct uf_set
 {
-  struct uf_set* parent;
-  Unsigned_Int id;
-  Unsigned_Int rank;
+  Unsigned_Int* parent;
+  Unsigned_Int size;
 };
 typedef struct uf_set UFSet;
 
 /* globals */
-extern UFSet** uf_sets;
+extern UFSet* uf_sets;
 
 /* funcitons */
-UFSet* UFSet_Make(Variable v);
-UFSet* UFSet_Find(UFSet* elem);  
-UFSet* UFSet_Union(UFSet* s1, UFSet* s2);
-UFSet* UFSet_Alloc();
-UFSet** UFSet_Create(unsigned int);
+Variable UFSet_Find(UFSet* sets, Variable v);  
+Variable UFSet_Union(UFSet* sets, Variable v1, Variable v2);
+bool UFSet_UnionConcurrent(UFSet* sets, Variable v1, Variable v2);
+void UFSet_Flatten(UFSet* sets);
+UFSet* UFSet_Create(unsigned int);
 void UFSets_Init(Arena, Unsigned_Int);
+void UFSets_Release();
 
 //helper function to allow easy lookup of variables
-UFSet* Find_Set(Variable v, UFSet** sets = uf_sets);
+Variable Find_Set(Variable v, UFSet* sets = uf_sets);
 
 #endif
 
-
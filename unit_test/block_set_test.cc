@@ -0,0 +1,123 @@
+
+#include <set>
+#include <vector>
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+#include "../block_set.h"
+#include "../Shared.h"
+
+static void CheckSame(const BlockSet& bs, const std::set<uint>& ref)
+{
+  assert(bs.size() == ref.size());
+  assert(bs.empty() == ref.empty());
+  std::vector<uint> elems;
+  bs.elements(elems);
+  assert(elems == std::vector<uint>(ref.begin(), ref.end()));
+  for(std::set<uint>::const_iterator it = ref.begin(); it != ref.end(); it++)
+    assert(bs.member(*it));
+}
+
+int main()
+{
+  Arena arena = Arena_Create();
+  ArenaAlloc::Use(arena);
+
+  printf("************* array to bitmap test ****************\n");
+  BlockSet bs;
+  std::set<uint> ref;
+  //every other block so the array is not just a run
+  for(uint b = 0; b < 2 * 256; b += 2){bs.insert(b); ref.insert(b);}
+  CheckSame(bs, ref);
+  //one past the array limit switches the chunk to a bitmap, which
+  //does not grow with more blocks
+  bs.insert(1001); ref.insert(1001);
+  uint bitmap_bytes = bs.bytes();
+  for(uint b = 1003; b < 2001; b += 2){bs.insert(b); ref.insert(b);}
+  assert(bs.bytes() == bitmap_bytes);
+  CheckSame(bs, ref);
+  assert(!bs.member(1));
+  assert(!bs.member(1000));
+
+  printf("************* bitmap to array test ****************\n");
+  //the chunk stays a bitmap until it drops well below the limit
+  std::set<uint>::iterator it = ref.begin();
+  while(ref.size() > 128)
+  {
+    bs.erase(*it); ref.erase(it++);
+  }
+  assert(bs.bytes() == bitmap_bytes);
+  CheckSame(bs, ref);
+  bs.erase(*it); ref.erase(it++);
+  assert(bs.bytes() < bitmap_bytes);
+  CheckSame(bs, ref);
+  while(!ref.empty()){bs.erase(*ref.begin()); ref.erase(ref.begin());}
+  CheckSame(bs, ref);
+
+  printf("************* chunk boundary test ****************\n");
+  BlockSet lo, hi;
+  lo.insert(4095);
+  hi.insert(4096);
+  assert(lo.member(4095) && !lo.member(4096));
+  assert(hi.member(4096) && !hi.member(4095));
+  assert(!lo.intersects(hi));
+  assert(!hi.intersects(lo));
+  lo.insert(0);
+  lo.insert(8192);
+  hi.insert(8191);
+  assert(!lo.intersects(hi));
+  hi.insert(8192);
+  assert(lo.intersects(hi));
+  assert(hi.intersects(lo));
+  //erasing the last block of a chunk drops it without touching its
+  //neighbors
+  lo.erase(4095);
+  assert(lo.size() == 2);
+  assert(lo.member(0) && lo.member(8192) && !lo.member(4095));
+  std::vector<uint> elems;
+  hi.elements(elems);
+  assert(elems.size() == 3);
+  assert(elems[0] == 4096 && elems[1] == 8191 && elems[2] == 8192);
+
+  printf("************* union test ****************\n");
+  //mixes arrays and bitmaps on both sides of several chunk boundaries
+  BlockSet u1, u2;
+  std::set<uint> ref1;
+  for(uint b = 0; b < 300; b++){u1.insert(b); ref1.insert(b);}
+  for(uint b = 4000; b < 4200; b++){u2.insert(b); ref1.insert(b);}
+  for(uint b = 8192; b < 8192 + 300; b += 3){u1.insert(b); ref1.insert(b);}
+  for(uint b = 8192; b < 8192 + 600; b += 2){u2.insert(b); ref1.insert(b);}
+  u2.insert(20000); ref1.insert(20000);
+  u1.Union(u2);
+  CheckSame(u1, ref1);
+  u1.Union(u1);
+  CheckSame(u1, ref1);
+
+  printf("************* random test ****************\n");
+  srand(1);
+  for(int round = 0; round < 100; round++)
+  {
+    BlockSet r1, r2;
+    std::set<uint> s1, s2;
+    uint range = 1 + rand() % 20000;
+    for(int i = 0; i < 2000; i++)
+    {
+      uint b = rand() % range;
+      if(rand() % 4){r1.insert(b); s1.insert(b);}
+      else          {r1.erase(b); s1.erase(b);}
+      b = rand() % range;
+      if(i % 8 == 0){r2.insert(b); s2.insert(b);}
+    }
+    CheckSame(r1, s1);
+    bool common = false;
+    for(it = s2.begin(); it != s2.end(); it++)
+      if(s1.count(*it)) common = true;
+    assert(r1.intersects(r2) == common);
+    r1.Union(r2);
+    s1.insert(s2.begin(), s2.end());
+    CheckSame(r1, s1);
+  }
+
+  printf("ALL TESTS PASSED\n");
+}
+
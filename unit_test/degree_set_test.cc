@@ -0,0 +1,106 @@
+
+#include <set>
+#include <vector>
+#include <stdlib.h>
+#include "../lazy_set.h"
+#include "../Shared.h"
+
+/* home slot of an id in a promoted table of the given capacity, the
+ * same multiplicative hash DegreeSet uses */
+static uint Home(uint id, uint capacity)
+{
+  return (id * 2654435761u) & (capacity - 1);
+}
+
+int main()
+{
+  Arena arena = Arena_Create();
+  ArenaAlloc::Use(arena);
+
+  printf("************* inline array test ****************\n");
+  DegreeSet ds;
+  for(uint id = 1; id <= 8; id++)
+  {
+    assert(ds.insert(id));
+    assert(!ds.insert(id));
+  }
+  //eight members still fit in the inline array
+  assert(ds.bytes() == sizeof(DegreeSet));
+  for(uint id = 1; id <= 8; id++) assert(ds.member(id));
+  assert(!ds.member(0));
+  assert(!ds.member(9));
+  assert(ds.erase(4));
+  assert(!ds.erase(4));
+  assert(!ds.member(4));
+  assert(ds.insert(4));
+
+  printf("************* switch to hash test ****************\n");
+  assert(ds.insert(9));
+  assert(ds.bytes() > sizeof(DegreeSet));
+  for(uint id = 1; id <= 9; id++) assert(ds.member(id));
+  assert(!ds.member(10));
+  //grows past the first table size
+  for(uint id = 10; id <= 100; id++) assert(ds.insert(id));
+  for(uint id = 1; id <= 100; id++) assert(ds.member(id));
+  assert(!ds.member(101));
+  ds.clear();
+  assert(ds.bytes() == sizeof(DegreeSet));
+  for(uint id = 1; id <= 100; id++) assert(!ds.member(id));
+
+  printf("************* backward shift delete test ****************\n");
+  //the first table has 32 slots and holds up to 16 members. find ids
+  //sharing a home slot so they form one probe run
+  const uint CAPACITY = 32;
+  std::vector<uint> same;
+  for(uint id = 1000; same.size() < 4; id++)
+  {
+    if(Home(id, CAPACITY) == Home(1000, CAPACITY)) same.push_back(id);
+  }
+  //fill the inline array with ids that do not collide, then promote
+  DegreeSet bs;
+  uint filler = 1;
+  for(uint i = 0; i < 8; filler++)
+  {
+    if(Home(filler, CAPACITY) == Home(1000, CAPACITY)) continue;
+    assert(bs.insert(filler)); i++;
+  }
+  for(uint i = 0; i < same.size(); i++) assert(bs.insert(same[i]));
+
+  //removing the head of the run must shift the rest back into reach
+  assert(bs.erase(same[0]));
+  assert(!bs.member(same[0]));
+  for(uint i = 1; i < same.size(); i++) assert(bs.member(same[i]));
+  //and the same from the middle of the run
+  assert(bs.erase(same[2]));
+  assert(bs.member(same[1]));
+  assert(!bs.member(same[2]));
+  assert(bs.member(same[3]));
+  assert(bs.erase(same[3]));
+  assert(bs.erase(same[1]));
+  for(uint i = 0; i < same.size(); i++) assert(!bs.member(same[i]));
+  for(uint id = 1; id < filler; id++)
+  {
+    if(Home(id, CAPACITY) == Home(1000, CAPACITY)) continue;
+    assert(bs.member(id));
+  }
+
+  printf("************* random test ****************\n");
+  srand(1);
+  for(int round = 0; round < 100; round++)
+  {
+    DegreeSet rs;
+    std::set<uint> ref;
+    uint range = 1 + rand() % 500;
+    for(int i = 0; i < 2000; i++)
+    {
+      uint id = rand() % range;
+      if(rand() % 3) assert(rs.insert(id) == ref.insert(id).second);
+      else           assert(rs.erase(id) == (ref.erase(id) > 0));
+    }
+    for(uint id = 0; id < range; id++)
+      assert(rs.member(id) == (ref.count(id) > 0));
+  }
+
+  printf("ALL TESTS PASSED\n");
+}
+
@@ -20,7 +20,7 @@ int main()
   LiveRange* lr5 = new LiveRange(rc,5,0);
 
 
-  LazySet* lz = new LazySet(arena, 100);
+  LazySet* lz = new LazySet;
 
   printf("************* insert test ****************\n");
   lz->insert(lr1);
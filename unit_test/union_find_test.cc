@@ -0,0 +1,106 @@
+
+#include <vector>
+#include <algorithm>
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+#include <pthread.h>
+#include "../union_find.h"
+#include "../Shared.h"
+
+/* names are joined into groups by their value mod GROUPS, so the root
+ * of each group must be the group number itself */
+static const Unsigned_Int NAMES = 10000;
+static const Unsigned_Int GROUPS = 37;
+static const long THREADS = 4;
+
+typedef std::vector<std::pair<Variable, Variable> > UnionList;
+struct Work
+{
+  UFSet* sets;
+  const UnionList* unions;
+  long worker;
+};
+
+static void* RunUnions(void* arg)
+{
+  Work* w = (Work*)arg;
+  for(size_t i = w->worker; i < w->unions->size(); i += THREADS)
+  {
+    const std::pair<Variable, Variable>& u = (*w->unions)[i];
+    UFSet_UnionConcurrent(w->sets, u.first, u.second);
+  }
+  return NULL;
+}
+
+static void CheckRoots(UFSet* sets)
+{
+  for(Variable v = 0; v < NAMES; v++)
+    assert(UFSet_Find(sets, v) == v % GROUPS);
+}
+
+int main()
+{
+  Arena arena = Arena_Create();
+  UFSets_Init(arena, NAMES);
+
+  //every name is linked to another name in its group
+  UnionList unions;
+  for(Variable v = GROUPS; v < NAMES; v++)
+    unions.push_back(std::make_pair(v, v - GROUPS));
+
+  printf("************* singleton test ****************\n");
+  UFSet* sets = UFSet_Create(NAMES);
+  for(Variable v = 0; v < NAMES; v++) assert(UFSet_Find(sets, v) == v);
+
+  printf("************* union order test ****************\n");
+  //in order, reversed, with swapped arguments and shuffled
+  sets = UFSet_Create(NAMES);
+  for(size_t i = 0; i < unions.size(); i++)
+    UFSet_Union(sets, unions[i].first, unions[i].second);
+  CheckRoots(sets);
+
+  sets = UFSet_Create(NAMES);
+  for(size_t i = unions.size(); i > 0; i--)
+    UFSet_Union(sets, unions[i-1].second, unions[i-1].first);
+  CheckRoots(sets);
+
+  srand(1);
+  UnionList shuffled(unions);
+  std::random_shuffle(shuffled.begin(), shuffled.end());
+  sets = UFSet_Create(NAMES);
+  for(size_t i = 0; i < shuffled.size(); i++)
+  {
+    Variable root = UFSet_Union(sets, shuffled[i].first, shuffled[i].second);
+    //the root of a union is never larger than either name
+    assert(root <= std::min(shuffled[i].first, shuffled[i].second));
+  }
+  CheckRoots(sets);
+
+  printf("************* concurrent union test ****************\n");
+  sets = UFSet_Create(NAMES);
+  pthread_t threads[THREADS];
+  Work work[THREADS];
+  for(long t = 0; t < THREADS; t++)
+  {
+    work[t].sets = sets;
+    work[t].unions = &shuffled;
+    work[t].worker = t;
+    pthread_create(&threads[t], NULL, RunUnions, &work[t]);
+  }
+  for(long t = 0; t < THREADS; t++) pthread_join(threads[t], NULL);
+  CheckRoots(sets);
+  //a second pass joins nothing new
+  for(size_t i = 0; i < shuffled.size(); i++)
+    assert(!UFSet_UnionConcurrent(sets, shuffled[i].first,
+                                  shuffled[i].second));
+
+  printf("************* flatten test ****************\n");
+  UFSet_Flatten(sets);
+  for(Variable v = 0; v < NAMES; v++) assert(sets->parent[v] == v % GROUPS);
+  CheckRoots(sets);
+
+  UFSets_Release();
+  printf("ALL TESTS PASSED\n");
+}
+